@@ -2,6 +2,7 @@
 #include "ring_buff_helper.h"
 #include "nxp_simtemp_sysfs_iface.h"
 #include "nxp_simtemp_dt_helper.h"
+#include "nxp_simtemp_genl.h"
 #include <linux/cdev.h>
 #include <linux/device.h>
 #include <linux/module.h>
@@ -13,27 +14,40 @@
 #include <linux/poll.h>
 #include <linux/of.h>
 #include <linux/of_device.h>
+#include <linux/slab.h>
+#include <linux/sched/signal.h>
+#include <linux/bitmap.h>
+#include <linux/math64.h>
+#include <linux/idr.h>
 
 /* Default temperature value */
-#define DEFAULT_TEMP 25000;
+#define DEFAULT_TEMP 25000
 
 /* Multiple devices support */
 #define MAX_DEVICES 10
 /* Driver private data structure */
 typedef struct simtemp_drv_priv_data {
-	unsigned int total_devices;
+	struct ida device_ida; // sensor ids, minors and device names
 	dev_t device_num_base;
 	struct class *class_simtemp;
 } simtemp_drv_priv_data_t;
 
-static simtemp_drv_priv_data_t simtemp_drv_data;
+static simtemp_drv_priv_data_t simtemp_drv_data = {
+	.device_ida = IDA_INIT(simtemp_drv_data.device_ida),
+};
 
 /*
 ** Function Prototypes
 */
 int simtemp_platform_driver_probe(struct platform_device *pdev);
 void simtemp_platform_driver_remove(struct platform_device *pdev);
-static int32_t simtemp_get_temperature(simtemp_sample_mode_e mode);
+static s64 simtemp_generate_frame(simtemp_channel_t *channels,
+				  unsigned int n_channels,
+				  simtemp_sample_mode_e mode);
+static unsigned int
+simtemp_adaptive_period(simtemp_dev_priv_data_t *p_dev_data, s64 distance,
+			s64 slope);
+static unsigned int simtemp_burst_size(simtemp_dev_priv_data_t *p_dev_data);
 static void simtemp_work_handler(struct work_struct *work);
 
 /*************** File operation functions ****************/
@@ -42,6 +56,7 @@ ssize_t simtemp_read(struct file *filp, char __user *buff, size_t count,
 ssize_t simtemp_write(struct file *filp, const char __user *buff, size_t count,
 		      loff_t *f_pos);
 unsigned int simtemp_poll(struct file *filp, struct poll_table_struct *wait);
+long simtemp_ioctl(struct file *filp, unsigned int cmd, unsigned long arg);
 int simtemp_open(struct inode *inode, struct file *filp);
 int simtemp_release(struct inode *inode, struct file *flip);
 
@@ -53,63 +68,269 @@ static struct file_operations simtemp_fops = { .open = simtemp_open,
 					       .read = simtemp_read,
 					       .poll = simtemp_poll,
 					       .write = simtemp_write,
+					       .unlocked_ioctl = simtemp_ioctl,
+					       .compat_ioctl = compat_ptr_ioctl,
 					       .llseek = noop_llseek,
 					       .owner = THIS_MODULE };
 
-ssize_t simtemp_read(struct file *filp, char __user *buff, size_t count,
-		     loff_t *f_pos)
+/*
+ * Key passed to the read_wq wake callbacks by the producer: the samples
+ * stored in this tick (a NULL key wakes every reader)
+ */
+typedef struct simtemp_wake_key {
+	unsigned int start; // ring position of the first new sample
+	unsigned int count; // new samples still in the ring
+	unsigned int woken; // readers actually woken up
+} simtemp_wake_key_t;
+
+/* Wait queue entry of a blocking reader */
+typedef struct simtemp_reader_wait {
+	struct wait_queue_entry wq_entry;
+	simtemp_file_ctx_t *ctx;
+} simtemp_reader_wait_t;
+
+/* Does the sample pass the reader's filter? */
+static bool simtemp_filter_match(simtemp_file_ctx_t *ctx,
+				 simtemp_sample_t *sample)
 {
-	int ret;
+	struct simtemp_filter *filter = &ctx->filter;
+
+	switch (filter->type) {
+	case SIMTEMP_FILTER_BAND:
+		return (sample->temp_mC < filter->low_mC) ||
+		       (sample->temp_mC > filter->high_mC);
+	case SIMTEMP_FILTER_DELTA:
+		/* Against the last delivered sample of the same channel */
+		return !test_bit(sample->channel, ctx->has_last_temp) ||
+		       (abs((s64)sample->temp_mC -
+			    ctx->last_temp_mC[sample->channel]) >=
+			filter->delta_mC);
+	case SIMTEMP_FILTER_DECIMATE:
+		/*
+		 * Whole frames in generation order, whatever was dropped or
+		 * filtered before (all channels of a frame share its seq)
+		 */
+		return (sample->seq % filter->decimation) == 0;
+	case SIMTEMP_FILTER_FLAGS:
+		return (sample->flags & filter->flags_mask) != 0;
+	default:
+		return true;
+	}
+}
 
-	simtemp_sample_t sample;
+/*
+ * Give the file a ring cursor on its first read()/poll(), starting from the
+ * oldest sample still in the ring. Files only used for stats or filters
+ * never hold ring space. Must be called with data_mutex held.
+ */
+static void simtemp_reader_attach(simtemp_file_ctx_t *ctx)
+{
+	simtemp_dev_priv_data_t *p_dev_data = ctx->p_dev_data;
 
-	simtemp_dev_priv_data_t *p_dev_data =
-		(simtemp_dev_priv_data_t *)filp->private_data;
+	if (ctx->is_reader)
+		return;
 
-	struct device *plat_dev = p_dev_data->device_simtemp->parent;
+	ctx->tail = p_dev_data->buffer->tail;
+	list_add_tail(&ctx->node, &p_dev_data->readers_list);
+	ctx->is_reader = true;
+	atomic_inc(&p_dev_data->readers);
+}
+
+/*
+ * Move the reader's cursor past the samples its filter rejects, so they
+ * neither hold ring space nor get scanned again. Returns true (and the
+ * sample) when one passes the filter. Must be called with data_mutex held.
+ */
+static bool simtemp_filter_skip(simtemp_file_ctx_t *ctx,
+				simtemp_sample_t *sample)
+{
+	simtemp_ring_buff_t *p_buff = ctx->p_dev_data->buffer;
+
+	/* Overwritten while this reader was behind */
+	if (rb_cursor_sync(p_buff, &ctx->tail))
+		ctx->gap_pending = true;
+
+	while (rb_cursor_peek(p_buff, ctx->tail, sample)) {
+		if (ctx->gap_pending)
+			sample->flags |= SIMTEMP_EVT_OVERRUN;
+		if (simtemp_filter_match(ctx, sample))
+			return true;
+		ctx->tail++;
+	}
+
+	return false;
+}
+
+/*
+ * The ring tail follows the slowest reader: slots every reader has gone past
+ * are free again. Must be called with data_mutex held.
+ */
+static void simtemp_update_tail(simtemp_dev_priv_data_t *p_dev_data)
+{
+	simtemp_ring_buff_t *p_buff = p_dev_data->buffer;
+	simtemp_file_ctx_t *ctx;
+	unsigned int pending = 0;
 
-	simtemp_ring_buff_t *p_buff = (simtemp_ring_buff_t *)p_dev_data->buffer;
+	/* Without readers the samples are kept for the next one */
+	if (list_empty(&p_dev_data->readers_list))
+		return;
 
-	dev_info(plat_dev, "Read requested for %zu bytes \n", count);
+	list_for_each_entry(ctx, &p_dev_data->readers_list, node)
+		pending = max(pending, rb_cursor_pending(p_buff, ctx->tail));
 
-	/* Non blocking call (return if no data is available) */
-	if ((filp->f_flags & O_NONBLOCK) && (rb_is_empty(p_buff))) {
-		return -EAGAIN;
+	p_buff->tail = p_buff->head - pending;
+}
+
+/*
+ * Copy up to 'max' samples passing the reader's filter and advance its
+ * cursor. The shared ring is left to the other readers. Must be called with
+ * data_mutex held.
+ */
+static size_t simtemp_filter_drain(simtemp_file_ctx_t *ctx,
+				   simtemp_sample_t *samples, size_t max)
+{
+	simtemp_sample_t sample;
+	size_t n_samples = 0;
+
+	while (n_samples < max && simtemp_filter_skip(ctx, &sample)) {
+		ctx->tail++;
+		ctx->gap_pending = false;
+		ctx->last_temp_mC[sample.channel] = sample.temp_mC;
+		__set_bit(sample.channel, ctx->has_last_temp);
+		samples[n_samples++] = sample;
 	}
 
-	/* Blocking call (wait if no data is available) */
-	if (wait_event_interruptible(p_dev_data->data_wq,
-				     (!rb_is_empty(p_buff))))
-		return -ERESTARTSYS;
+	simtemp_update_tail(ctx->p_dev_data);
 
-	if (mutex_lock_interruptible(&p_dev_data->data_mutex))
-		return -ERESTARTSYS;
+	return n_samples;
+}
 
-	ret = rb_get(p_buff, &sample);
+/*
+ * Only wake a blocking reader if its filter accepts one of the new samples.
+ * The worker is the only writer of the ring slots, so the new ones are
+ * stable while it runs __wake_up().
+ */
+static int simtemp_reader_wake(struct wait_queue_entry *wq_entry,
+			       unsigned int mode, int sync, void *key)
+{
+	simtemp_reader_wait_t *wait =
+		container_of(wq_entry, simtemp_reader_wait_t, wq_entry);
+	simtemp_wake_key_t *wake_key = key;
+	simtemp_ring_buff_t *p_buff = wait->ctx->p_dev_data->buffer;
+	simtemp_sample_t sample;
+	unsigned int i;
 
-	mutex_unlock(&p_dev_data->data_mutex);
+	int ret;
 
-	if (!ret) {
-		/* The ring buffer is empty (not expected) */
-		return -EFAULT;
+	if (wake_key) {
+		for (i = 0; i < wake_key->count; i++) {
+			rb_cursor_peek(p_buff, wake_key->start + i, &sample);
+			if (simtemp_filter_match(wait->ctx, &sample))
+				break;
+		}
+		if (i == wake_key->count)
+			return 0;
 	}
 
-	if (copy_to_user(buff, &sample, sizeof(sample))) {
-		return -EFAULT;
+	ret = autoremove_wake_function(wq_entry, mode, sync, key);
+	if (ret && wake_key)
+		wake_key->woken++;
+
+	return ret;
+}
+
+ssize_t simtemp_read(struct file *filp, char __user *buff, size_t count,
+		     loff_t *f_pos)
+{
+	simtemp_sample_t samples[SIMTEMP_READ_BATCH];
+	size_t max_samples;
+	size_t n_samples;
+	size_t n_chunk;
+	unsigned int seen;
+	bool is_fault;
+
+	simtemp_file_ctx_t *ctx = (simtemp_file_ctx_t *)filp->private_data;
+
+	simtemp_dev_priv_data_t *p_dev_data = ctx->p_dev_data;
+
+	struct device *plat_dev = p_dev_data->device_simtemp->parent;
+
+	simtemp_reader_wait_t wait = { .ctx = ctx };
+
+	dev_dbg(plat_dev, "Read requested for %zu bytes \n", count);
+
+	/* Whole samples only, as many as fit */
+	max_samples = count / sizeof(simtemp_sample_t);
+	if (!max_samples)
+		return -EINVAL;
+
+	init_wait_func(&wait.wq_entry, simtemp_reader_wake);
+
+	for (;;) {
+		if (mutex_lock_interruptible(&p_dev_data->data_mutex))
+			return -ERESTARTSYS;
+
+		simtemp_reader_attach(ctx);
+
+		/*
+		 * A whole frame or burst in one read(), copied out in chunks
+		 * so the stack buffer stays small
+		 */
+		n_samples = 0;
+		is_fault = false;
+		do {
+			n_chunk = simtemp_filter_drain(
+				ctx, samples,
+				min_t(size_t, max_samples - n_samples,
+				      SIMTEMP_READ_BATCH));
+			if (copy_to_user(buff + n_samples * sizeof(samples[0]),
+					 samples, n_chunk * sizeof(samples[0]))) {
+				is_fault = true;
+				break;
+			}
+			n_samples += n_chunk;
+		} while (n_chunk == SIMTEMP_READ_BATCH &&
+			 n_samples < max_samples);
+		seen = p_dev_data->buffer->head;
+
+		mutex_unlock(&p_dev_data->data_mutex);
+
+		/* Report what was copied before the fault, if anything */
+		if (is_fault && !n_samples)
+			return -EFAULT;
+		if (n_samples)
+			break;
+
+		/* Non blocking call (return if no data is available) */
+		if (filp->f_flags & O_NONBLOCK)
+			return -EAGAIN;
+
+		/* Blocking call (sleep until a sample passes the filter) */
+		prepare_to_wait(&p_dev_data->read_wq, &wait.wq_entry,
+				TASK_INTERRUPTIBLE);
+		if (READ_ONCE(p_dev_data->buffer->head) == seen &&
+		    !signal_pending(current))
+			schedule();
+		finish_wait(&p_dev_data->read_wq, &wait.wq_entry);
+
+		if (signal_pending(current))
+			return -ERESTARTSYS;
 	}
-	dev_info(plat_dev, "Read succeded: timestamp_ns=%llu, temp_mC=%d\n",
-		 sample.timestamp_ns, sample.temp_mC);
 
-	return sizeof(sample);
+	dev_dbg(plat_dev, "Read succeded: %zu samples\n", n_samples);
+
+	SIMTEMP_STATS_ADD(p_dev_data, reads, 1);
+	SIMTEMP_STATS_ADD(p_dev_data, bytes, n_samples * sizeof(samples[0]));
+
+	return n_samples * sizeof(samples[0]);
 }
 
 ssize_t simtemp_write(struct file *filp, const char __user *buff, size_t count,
 		      loff_t *f_pos)
 {
-	simtemp_dev_priv_data_t *p_dev_data =
-		(simtemp_dev_priv_data_t *)filp->private_data;
+	simtemp_file_ctx_t *ctx = (simtemp_file_ctx_t *)filp->private_data;
 
-	struct device *plat_dev = p_dev_data->device_simtemp->parent;
+	struct device *plat_dev = ctx->p_dev_data->device_simtemp->parent;
 
 	dev_err(plat_dev, "Write operation not permited \n");
 
@@ -120,34 +341,110 @@ unsigned int simtemp_poll(struct file *filp, struct poll_table_struct *wait)
 {
 	unsigned int mask = 0;
 
-	simtemp_dev_priv_data_t *p_dev_data =
-		(simtemp_dev_priv_data_t *)filp->private_data;
+	simtemp_file_ctx_t *ctx = (simtemp_file_ctx_t *)filp->private_data;
+
+	simtemp_dev_priv_data_t *p_dev_data = ctx->p_dev_data;
 
 	struct device *plat_dev = p_dev_data->device_simtemp->parent;
 
-	simtemp_ring_buff_t *p_buff = (simtemp_ring_buff_t *)p_dev_data->buffer;
+	simtemp_sample_t sample;
+
+	dev_dbg(plat_dev, "Poll requested \n");
 
-	dev_info(plat_dev, "Poll requested \n");
+	SIMTEMP_STATS_ADD(p_dev_data, polls, 1);
 
 	poll_wait(filp, &p_dev_data->data_wq, wait);
 
-	/* Normal read data event */
-	if (!rb_is_empty(p_buff)) {
+	mutex_lock(&p_dev_data->data_mutex);
+
+	simtemp_reader_attach(ctx);
+
+	/* Normal read data event (only samples passing the filter) */
+	if (simtemp_filter_skip(ctx, &sample)) {
 		mask |= (POLLIN | POLLRDNORM);
-	}
 
-	/* Threshold crossed (HIPRIO) */
-	simtemp_sample_t sample;
-	if (rb_peek(p_buff, &sample) && (sample.flags & SIMTEMP_EVT_THRS)) {
-		mask |= POLLPRI;
+		/* Threshold crossed (HIPRIO) */
+		if (sample.flags & SIMTEMP_EVT_THRS)
+			mask |= POLLPRI;
 	}
+	simtemp_update_tail(p_dev_data);
+
+	mutex_unlock(&p_dev_data->data_mutex);
 
 	return mask;
 }
 
+static int simtemp_filter_validate(struct simtemp_filter *filter)
+{
+	switch (filter->type) {
+	case SIMTEMP_FILTER_NONE:
+	case SIMTEMP_FILTER_DELTA:
+	case SIMTEMP_FILTER_FLAGS:
+		return 0;
+	case SIMTEMP_FILTER_BAND:
+		return (filter->low_mC <= filter->high_mC) ? 0 : -EINVAL;
+	case SIMTEMP_FILTER_DECIMATE:
+		return (filter->decimation > 0) ? 0 : -EINVAL;
+	default:
+		return -EINVAL;
+	}
+}
+
+long simtemp_ioctl(struct file *filp, unsigned int cmd, unsigned long arg)
+{
+	int ret;
+	struct simtemp_filter filter;
+	struct simtemp_stats stats;
+
+	simtemp_file_ctx_t *ctx = (simtemp_file_ctx_t *)filp->private_data;
+
+	simtemp_dev_priv_data_t *p_dev_data = ctx->p_dev_data;
+
+	switch (cmd) {
+	case SIMTEMP_IOC_SET_FILTER:
+		if (copy_from_user(&filter, (void __user *)arg, sizeof(filter)))
+			return -EFAULT;
+
+		ret = simtemp_filter_validate(&filter);
+		if (ret)
+			return ret;
+
+		mutex_lock(&p_dev_data->data_mutex);
+		ctx->filter = filter;
+		bitmap_zero(ctx->has_last_temp, SIMTEMP_CHANNELS_MAX);
+		mutex_unlock(&p_dev_data->data_mutex);
+
+		/* Let sleeping readers re-evaluate with the new filter */
+		wake_up_interruptible(&p_dev_data->read_wq);
+		wake_up_interruptible(&p_dev_data->data_wq);
+		return 0;
+
+	case SIMTEMP_IOC_GET_FILTER:
+		mutex_lock(&p_dev_data->data_mutex);
+		filter = ctx->filter;
+		mutex_unlock(&p_dev_data->data_mutex);
+
+		if (copy_to_user((void __user *)arg, &filter, sizeof(filter)))
+			return -EFAULT;
+		return 0;
+
+	case SIMTEMP_IOC_GET_STATS:
+		/* Lock-free: never contends with the sampler */
+		simtemp_stats_snapshot(p_dev_data, &stats);
+
+		if (copy_to_user((void __user *)arg, &stats, sizeof(stats)))
+			return -EFAULT;
+		return 0;
+
+	default:
+		return -ENOTTY;
+	}
+}
+
 int simtemp_open(struct inode *inode, struct file *filp)
 {
 	simtemp_dev_priv_data_t *p_dev_data;
+	simtemp_file_ctx_t *ctx;
 
 	/* Get device's private data structure */
 	p_dev_data = container_of(inode->i_cdev, simtemp_dev_priv_data_t, cdev);
@@ -156,9 +453,6 @@ int simtemp_open(struct inode *inode, struct file *filp)
 
 	dev_info(plat_dev, "minor access = %d\n", MINOR(inode->i_rdev));
 
-	/* To supply device private data to FOPS methods of the driver */
-	filp->private_data = p_dev_data;
-
 	/* The char device is only for readings (data path) */
 	if ((filp->f_mode & FMODE_WRITE)) {
 		dev_warn(plat_dev,
@@ -166,6 +460,17 @@ int simtemp_open(struct inode *inode, struct file *filp)
 		return -EPERM;
 	}
 
+	/* Per reader context (no filter by default) */
+	ctx = kzalloc(sizeof(*ctx), GFP_KERNEL);
+	if (!ctx)
+		return -ENOMEM;
+
+	ctx->p_dev_data = p_dev_data;
+	ctx->filter.type = SIMTEMP_FILTER_NONE;
+
+	/* To supply the reader context to FOPS methods of the driver */
+	filp->private_data = ctx;
+
 	dev_info(plat_dev, "Open was successful\n");
 
 	return 0;
@@ -174,48 +479,134 @@ int simtemp_open(struct inode *inode, struct file *filp)
 int simtemp_release(struct inode *inode, struct file *flip)
 {
 	simtemp_dev_priv_data_t *p_dev_data;
+	simtemp_file_ctx_t *ctx = (simtemp_file_ctx_t *)flip->private_data;
 
 	/* Get device's private data structure */
 	p_dev_data = container_of(inode->i_cdev, simtemp_dev_priv_data_t, cdev);
 
 	struct device *plat_dev = p_dev_data->device_simtemp->parent;
 
+	/* The samples only this reader was holding are free again */
+	if (ctx->is_reader) {
+		mutex_lock(&p_dev_data->data_mutex);
+		list_del(&ctx->node);
+		simtemp_update_tail(p_dev_data);
+		mutex_unlock(&p_dev_data->data_mutex);
+		atomic_dec(&p_dev_data->readers);
+	}
+
+	kfree(ctx);
+
 	dev_info(plat_dev, "release was successful\n");
 
 	return 0;
 }
 
 /* Work handler code */
-static int32_t simtemp_get_temperature(simtemp_sample_mode_e mode)
+
+/*
+ * Generate the next frame of every channel in one pass over the contiguous
+ * channel state (one random draw for the whole frame). Returns the largest
+ * step since the previous frame. Must be called with config_mutex held.
+ */
+static s64 simtemp_generate_frame(simtemp_channel_t *channels,
+				  unsigned int n_channels,
+				  simtemp_sample_mode_e mode)
 {
-	static int32_t temperature = DEFAULT_TEMP;
-	int32_t n_rand;
+	int32_t noise[SIMTEMP_CHANNELS_MAX];
+	int32_t temperature;
+	s64 slope = 0;
+	unsigned int i;
 
-	switch (mode) {
-	case SIMTEMP_MODE_NORMAL:
-		temperature = DEFAULT_TEMP;
+	if (mode != SIMTEMP_MODE_RAMP) {
 		wait_for_random_bytes();
-		get_random_bytes(&n_rand, sizeof(n_rand));
-		n_rand = n_rand % 100; // +/- 100m degree noise
-		temperature += n_rand;
-		break;
-	case SIMTEMP_MODE_NOISY:
-		temperature = DEFAULT_TEMP;
-		wait_for_random_bytes();
-		get_random_bytes(&n_rand, sizeof(n_rand));
-		n_rand = n_rand % 1000; // +/- 1 degree noise
-		temperature += n_rand;
-		break;
-	case SIMTEMP_MODE_RAMP:
-		temperature += 1000; // 1 degree step
-		temperature = temperature % 100000; // 100 degree limit
-		break;
+		get_random_bytes(noise, n_channels * sizeof(noise[0]));
+	}
 
-	default:
-		break;
+	for (i = 0; i < n_channels; i++) {
+		simtemp_channel_t *ch = &channels[i];
+
+		switch (mode) {
+		case SIMTEMP_MODE_NORMAL:
+			/* +/- 100m degree noise */
+			temperature = DEFAULT_TEMP + noise[i] % 100;
+			break;
+		case SIMTEMP_MODE_NOISY:
+			/* +/- 1 degree noise */
+			temperature = DEFAULT_TEMP + noise[i] % 1000;
+			break;
+		case SIMTEMP_MODE_RAMP:
+			/* 1 degree step, 100 degree limit */
+			temperature = (ch->temp_mC + 1000) % 100000;
+			break;
+		default:
+			temperature = ch->temp_mC;
+			break;
+		}
+
+		slope = max_t(s64, slope, abs((s64)temperature - ch->temp_mC));
+		ch->temp_mC = temperature;
+	}
+
+	return slope;
+}
+
+/*
+ * Adaptive sampling: shrink the period near the threshold or on steep
+ * slopes, stretch it while the temperature is far away and stable.
+ * 'distance' and 'slope' are the worst case over the channels of the last
+ * frame. Must be called with config_mutex held.
+ */
+static unsigned int
+simtemp_adaptive_period(simtemp_dev_priv_data_t *p_dev_data, s64 distance,
+			s64 slope)
+{
+	simtemp_plat_data_t *pdata = &p_dev_data->pdata;
+	unsigned int period = p_dev_data->effective_sampling_ms;
+
+	if (distance <= SIMTEMP_ADAPT_NEAR_MC ||
+	    slope >= SIMTEMP_ADAPT_STEEP_MC) {
+		/* Alerts are likely: react fast */
+		period /= 2;
+	} else if (distance >= SIMTEMP_ADAPT_FAR_MC &&
+		   slope <= SIMTEMP_ADAPT_STABLE_MC) {
+		/* Cold and stable: back off gradually */
+		period += period / 4 + 1;
 	}
 
-	return temperature;
+	return clamp(period, pdata->min_sampling_ms, pdata->max_sampling_ms);
+}
+
+/*
+ * Samples to generate in this tick according to the burst pattern.
+ * Must be called with config_mutex held.
+ */
+static unsigned int simtemp_burst_size(simtemp_dev_priv_data_t *p_dev_data)
+{
+	simtemp_plat_data_t *pdata = &p_dev_data->pdata;
+	u8 trials[SIMTEMP_BURST_MAX];
+	unsigned int n_burst = 0;
+	unsigned int i;
+
+	switch (pdata->burst_pattern) {
+	case SIMTEMP_BURST_STEADY:
+		return pdata->burst_count;
+	case SIMTEMP_BURST_SPIKES:
+		return (p_dev_data->tick++ % SIMTEMP_BURST_SPIKE_TICKS) ?
+			       1 :
+			       pdata->burst_count;
+	case SIMTEMP_BURST_POISSON:
+		/*
+		 * Binomial(SIMTEMP_BURST_MAX, burst_count / SIMTEMP_BURST_MAX)
+		 * arrivals, close to Poisson for burst_count << SIMTEMP_BURST_MAX
+		 */
+		get_random_bytes(trials, sizeof(trials));
+		for (i = 0; i < SIMTEMP_BURST_MAX; i++)
+			n_burst += (trials[i] < pdata->burst_count);
+		return n_burst;
+	default:
+		return 1;
+	}
 }
 
 static void simtemp_work_handler(struct work_struct *work)
@@ -230,33 +621,198 @@ static void simtemp_work_handler(struct work_struct *work)
 	/* Locking control data */
 	mutex_lock(&p_dev_data->config_mutex);
 
-	int p_sampling_ms = p_dev_data->pdata.sampling_ms;
-	ktime_t kt = ktime_get_real();
-	int32_t new_temp = simtemp_get_temperature(p_dev_data->pdata.mode);
-	bool is_threshold_crossed = (new_temp > p_dev_data->pdata.threshold_mC);
-	uint32_t new_flags = is_threshold_crossed ?
-				     (SIMTEMP_EVT_NEW | SIMTEMP_EVT_THRS) :
-				     SIMTEMP_EVT_NEW;
-
-	/* Statistics */
-	p_dev_data->update_count++;
-	if (is_threshold_crossed)
-		p_dev_data->alert_count++;
-
-	mutex_unlock(&p_dev_data->config_mutex);
+	simtemp_ovf_policy_e policy = p_dev_data->pdata.overflow_policy;
+	simtemp_channel_t *channels = p_dev_data->channels;
+	unsigned int n_channels = p_dev_data->n_channels;
+
+	/* One frame (a sample per channel) per burst slot, bounded per tick */
+	unsigned int n_frames = min(simtemp_burst_size(p_dev_data),
+				    SIMTEMP_BURST_MAX / n_channels);
+
+	/* Backpressure: only generate what fits, hold while the buffer is full */
+	if (policy == SIMTEMP_OVF_BLOCK) {
+		simtemp_file_ctx_t *ctx;
+		simtemp_sample_t pending;
+
+		mutex_lock(&p_dev_data->data_mutex);
+		/* Samples a reader's filter rejects do not hold room */
+		list_for_each_entry(ctx, &p_dev_data->readers_list, node)
+			simtemp_filter_skip(ctx, &pending);
+		simtemp_update_tail(p_dev_data);
+
+		/* Only a reader that is behind holds the generator */
+		unsigned int room =
+			list_empty(&p_dev_data->readers_list) ?
+				TEMP_SAMPLE_BUF_SIZE :
+				TEMP_SAMPLE_BUF_SIZE -
+					rb_count(p_dev_data->buffer);
+		mutex_unlock(&p_dev_data->data_mutex);
+
+		if (room < n_channels) {
+			unsigned int retry_ms = p_dev_data->effective_sampling_ms;
+			mutex_unlock(&p_dev_data->config_mutex);
+			schedule_delayed_work(&p_dev_data->d_work,
+					      msecs_to_jiffies(retry_ms));
+			return;
+		}
+		n_frames = min(n_frames, room / n_channels);
+	}
 
-	/* Filling sample data */
+	/*
+	 * Synthetic timestamps: the frames are spread backwards over the
+	 * elapsed period, the newest one at 'now', never in the future nor
+	 * at or before the previous tick's newest frame.
+	 */
+	u64 first_ns = p_dev_data->last_timestamp_ns + 1;
+	u64 end_ns = max_t(u64, ktime_get_real(), first_ns);
+	u64 period_ns = (u64)p_dev_data->effective_sampling_ms * NSEC_PER_MSEC;
+	u64 step_ns = 0;
+
+	if (n_frames > 1)
+		step_ns = min(div_u64(period_ns, n_frames),
+			      div_u64(end_ns - first_ns, n_frames - 1));
+
+	u64 base_ns = n_frames ? end_ns - (n_frames - 1) * step_ns : end_ns;
+	u32 sensor_id = p_dev_data->sensor_id;
+	bool overwrite = (policy == SIMTEMP_OVF_OVERWRITE);
+
+	DECLARE_BITMAP(edge_mask, SIMTEMP_CHANNELS_MAX);
 	simtemp_sample_t sample;
-	sample.timestamp_ns = kt;
-	sample.temp_mC = new_temp;
-	sample.flags = new_flags;
+	s64 distance = S64_MAX;
+	s64 slope = 0;
+	unsigned int n_alerts = 0;
+	unsigned int n_lost = 0;
+	unsigned int n_stored = 0;
+	unsigned int i, c;
+	simtemp_wake_key_t wake_key = { 0 };
+
+	bitmap_zero(edge_mask, SIMTEMP_CHANNELS_MAX);
 
-	/* Locking consumer data */
+	/* Locking consumer data (the whole tick is one transaction) */
 	mutex_lock(&p_dev_data->data_mutex);
-	rb_put(p_dev_data->buffer, &sample);
+
+	/*
+	 * Without readers the ring just keeps the newest samples for the
+	 * next one: no backpressure and nobody loses anything.
+	 */
+	bool has_readers = !list_empty(&p_dev_data->readers_list);
+	bool drop_oldest = overwrite || !has_readers;
+
+	for (i = 0; i < n_frames; i++) {
+		slope = simtemp_generate_frame(channels, n_channels,
+					       p_dev_data->pdata.mode);
+		distance = S64_MAX;
+
+		/* Every sample of a frame shares its timestamp and seq */
+		sample.timestamp_ns = base_ns + i * step_ns;
+		sample.seq = p_dev_data->seq++;
+
+		for (c = 0; c < n_channels; c++) {
+			simtemp_channel_t *ch = &channels[c];
+			bool is_threshold_crossed =
+				(ch->temp_mC > ch->threshold_mC);
+
+			/* Filling sample data */
+			sample.temp_mC = ch->temp_mC;
+			sample.flags = is_threshold_crossed ?
+					       (SIMTEMP_EVT_NEW |
+						SIMTEMP_EVT_THRS) :
+					       SIMTEMP_EVT_NEW;
+			sample.channel = c;
+
+			/*
+			 * Alert channel only reports crossings (edges), one
+			 * message per channel and tick: the last crossing,
+			 * with the count of the ones coalesced into it.
+			 */
+			if (is_threshold_crossed != ch->is_above) {
+				simtemp_edge_t *edge = &p_dev_data->edges[c];
+
+				if (!__test_and_set_bit(c, edge_mask))
+					edge->count = 0;
+				edge->sample = sample;
+				edge->threshold_mC = ch->threshold_mC;
+				edge->count++;
+			}
+			ch->is_above = is_threshold_crossed;
+			n_alerts += is_threshold_crossed;
+			distance = min_t(s64, distance,
+					 abs((s64)ch->threshold_mC -
+					     ch->temp_mC));
+
+			/*
+			 * Overwriting only moves the shared tail: each reader
+			 * flags its own gap when its cursor falls behind it.
+			 */
+			bool is_lost = rb_put(p_dev_data->buffer, &sample,
+					      drop_oldest);
+
+			n_lost += (is_lost && has_readers);
+			n_stored += (drop_oldest || !is_lost);
+		}
+	}
+
+	/* New samples still in the ring, for the filtered wake up */
+	wake_key.count = min(n_stored, rb_count(p_dev_data->buffer));
+	wake_key.start = p_dev_data->buffer->head - wake_key.count;
+
 	mutex_unlock(&p_dev_data->data_mutex);
 
-	wake_up_interruptible(&p_dev_data->data_wq);
+	if (n_frames) {
+		p_dev_data->last_timestamp_ns = sample.timestamp_ns;
+
+		/* Next period (fixed or adaptive), from the newest frame */
+		if (p_dev_data->pdata.adaptive)
+			p_dev_data->effective_sampling_ms =
+				simtemp_adaptive_period(p_dev_data, distance,
+							slope);
+	}
+	if (!p_dev_data->pdata.adaptive)
+		p_dev_data->effective_sampling_ms = p_dev_data->pdata.sampling_ms;
+
+	unsigned int p_sampling_ms = p_dev_data->effective_sampling_ms;
+
+	simtemp_edge_t *edges = p_dev_data->edges;
+
+	mutex_unlock(&p_dev_data->config_mutex);
+
+	/*
+	 * Last crossing (and crossing count) of each channel in this tick,
+	 * sent without holding config_mutex (sysfs stays responsive). The
+	 * edges (with their thresholds) are only touched by this worker.
+	 */
+	for_each_set_bit(c, edge_mask, n_channels)
+		simtemp_genl_notify_alert(sensor_id, &edges[c].sample,
+					  edges[c].threshold_mC,
+					  edges[c].sample.flags &
+						  SIMTEMP_EVT_THRS,
+					  edges[c].count);
+
+	/*
+	 * One wake up per queue per tick, whatever the number of samples.
+	 * 'wakeups' counts the queues (pollers, blocking readers) on which
+	 * it woke at least one task.
+	 */
+	unsigned int n_wakeups = 0;
+
+	if (n_stored) {
+		n_wakeups += wq_has_sleeper(&p_dev_data->data_wq);
+		wake_up_interruptible(&p_dev_data->data_wq);
+		/* Readers whose filter rejects every new sample keep sleeping */
+		__wake_up(&p_dev_data->read_wq, TASK_INTERRUPTIBLE, 0,
+			  &wake_key);
+		n_wakeups += (wake_key.woken != 0);
+	}
+
+	/* Statistics (per-CPU, outside of the locks) */
+	simtemp_stats_pcpu_t *pcpu = get_cpu_ptr(p_dev_data->stats);
+	u64_stats_update_begin(&pcpu->syncp);
+	u64_stats_add(&pcpu->updates, n_frames * n_channels);
+	u64_stats_add(&pcpu->alerts, n_alerts);
+	u64_stats_add(&pcpu->overruns, n_lost);
+	u64_stats_add(&pcpu->wakeups, n_wakeups);
+	u64_stats_update_end(&pcpu->syncp);
+	put_cpu_ptr(p_dev_data->stats);
 
 	/* For periodic callback */
 	schedule_delayed_work(&p_dev_data->d_work,
@@ -268,21 +824,76 @@ static DEVICE_ATTR_RW(sampling_ms);
 static DEVICE_ATTR_RW(threshold_mc);
 static DEVICE_ATTR_RW(mode);
 static DEVICE_ATTR_RO(stats);
+static DEVICE_ATTR_RW(adaptive);
+static DEVICE_ATTR_RW(min_sampling_ms);
+static DEVICE_ATTR_RW(max_sampling_ms);
+static DEVICE_ATTR_RO(effective_sampling_ms);
+static DEVICE_ATTR_RW(overflow_policy);
+static DEVICE_ATTR_RW(burst_pattern);
+static DEVICE_ATTR_RW(burst_count);
+static DEVICE_ATTR_RO(channels);
+static DEVICE_ATTR_RW(thresholds_mc);
 
 static struct attribute *simtemp_sensor_attrs[] = {
 	&dev_attr_sampling_ms.attr,
 	&dev_attr_threshold_mc.attr,
 	&dev_attr_mode.attr,
 	&dev_attr_stats.attr,
+	&dev_attr_adaptive.attr,
+	&dev_attr_min_sampling_ms.attr,
+	&dev_attr_max_sampling_ms.attr,
+	&dev_attr_effective_sampling_ms.attr,
+	&dev_attr_overflow_policy.attr,
+	&dev_attr_burst_pattern.attr,
+	&dev_attr_burst_count.attr,
+	&dev_attr_channels.attr,
+	&dev_attr_thresholds_mc.attr,
 	NULL,
 };
 
-ATTRIBUTE_GROUPS(simtemp_sensor);
+static const struct attribute_group simtemp_sensor_group = {
+	.attrs = simtemp_sensor_attrs,
+};
+
+/* One value per file under statistics/ (lock-free) */
+static DEVICE_ATTR_RO(updates);
+static DEVICE_ATTR_RO(alerts);
+static DEVICE_ATTR_RO(overruns);
+static DEVICE_ATTR_RO(reads);
+static DEVICE_ATTR_RO(bytes);
+static DEVICE_ATTR_RO(polls);
+static DEVICE_ATTR_RO(wakeups);
+static DEVICE_ATTR_RO(readers);
+
+static struct attribute *simtemp_stats_attrs[] = {
+	&dev_attr_updates.attr,
+	&dev_attr_alerts.attr,
+	&dev_attr_overruns.attr,
+	&dev_attr_reads.attr,
+	&dev_attr_bytes.attr,
+	&dev_attr_polls.attr,
+	&dev_attr_wakeups.attr,
+	&dev_attr_readers.attr,
+	NULL,
+};
+
+static const struct attribute_group simtemp_stats_group = {
+	.name = "statistics",
+	.attrs = simtemp_stats_attrs,
+};
+
+static const struct attribute_group *simtemp_sensor_groups[] = {
+	&simtemp_sensor_group,
+	&simtemp_stats_group,
+	NULL,
+};
 
 /* Called when matched platform device is found */
 int simtemp_platform_driver_probe(struct platform_device *pdev)
 {
 	int ret;
+	unsigned int i;
+	int cpu;
 	simtemp_plat_data_t *pdata;
 
 	/* Device private data ptr */
@@ -317,12 +928,67 @@ int simtemp_platform_driver_probe(struct platform_device *pdev)
 	dev_data->pdata.sampling_ms = pdata->sampling_ms;
 	dev_data->pdata.threshold_mC = pdata->threshold_mC;
 	dev_data->pdata.mode = pdata->mode;
+	dev_data->pdata.overflow_policy = pdata->overflow_policy;
+	dev_data->pdata.adaptive = pdata->adaptive;
+	dev_data->pdata.min_sampling_ms = pdata->min_sampling_ms ?:
+						  SIMTEMP_DEFAULT_MIN_SAMPLING_MS;
+	dev_data->pdata.max_sampling_ms = pdata->max_sampling_ms ?:
+						  SIMTEMP_DEFAULT_MAX_SAMPLING_MS;
+
+	if (dev_data->pdata.min_sampling_ms > dev_data->pdata.max_sampling_ms) {
+		dev_warn(&pdev->dev,
+			 "Invalid adaptive sampling bounds (using defaults)\n");
+		dev_data->pdata.min_sampling_ms =
+			SIMTEMP_DEFAULT_MIN_SAMPLING_MS;
+		dev_data->pdata.max_sampling_ms =
+			SIMTEMP_DEFAULT_MAX_SAMPLING_MS;
+	}
+
+	dev_data->pdata.burst_pattern = pdata->burst_pattern;
+	dev_data->pdata.burst_count =
+		clamp(pdata->burst_count, 1U, (unsigned int)SIMTEMP_BURST_MAX);
+
+	/* The first period is the configured one (clamped if adaptive) */
+	dev_data->effective_sampling_ms =
+		dev_data->pdata.adaptive ?
+			clamp(dev_data->pdata.sampling_ms,
+			      dev_data->pdata.min_sampling_ms,
+			      dev_data->pdata.max_sampling_ms) :
+			dev_data->pdata.sampling_ms;
 
 	dev_info(&pdev->dev, "Device sampling_ms = %d\n",
 		 dev_data->pdata.sampling_ms);
 	dev_info(&pdev->dev, "Device threshold_mC = %d\n",
 		 dev_data->pdata.threshold_mC);
 	dev_info(&pdev->dev, "Device mode = %d\n", dev_data->pdata.mode);
+	dev_info(&pdev->dev, "Device overflow policy = %d\n",
+		 dev_data->pdata.overflow_policy);
+	dev_info(&pdev->dev, "Device adaptive = %d [%u, %u] ms\n",
+		 dev_data->pdata.adaptive, dev_data->pdata.min_sampling_ms,
+		 dev_data->pdata.max_sampling_ms);
+	dev_info(&pdev->dev, "Device burst pattern = %d (%u samples)\n",
+		 dev_data->pdata.burst_pattern, dev_data->pdata.burst_count);
+
+	/* Channels (one frame of samples per tick) */
+	dev_data->n_channels = clamp(pdata->channels ?: 1, 1U,
+				     (unsigned int)SIMTEMP_CHANNELS_MAX);
+	dev_data->channels = devm_kcalloc(&pdev->dev, dev_data->n_channels,
+					  sizeof(*dev_data->channels),
+					  GFP_KERNEL);
+	dev_data->edges = devm_kcalloc(&pdev->dev, dev_data->n_channels,
+				       sizeof(*dev_data->edges), GFP_KERNEL);
+	if (!dev_data->channels || !dev_data->edges) {
+		dev_err(&pdev->dev, "Cannot allocate memory\n");
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < dev_data->n_channels; i++) {
+		dev_data->channels[i].temp_mC = DEFAULT_TEMP;
+		dev_data->channels[i].threshold_mC =
+			pdata->thresholds_mC ? pdata->thresholds_mC[i] :
+					       pdata->threshold_mC;
+	}
+	dev_info(&pdev->dev, "Device channels = %u\n", dev_data->n_channels);
 
 	/* Dynamically allocate memory using for the buffer */
 	dev_data->buffer =
@@ -332,17 +998,37 @@ int simtemp_platform_driver_probe(struct platform_device *pdev)
 		return -ENOMEM;
 	}
 
+	/* Per-CPU statistics */
+	dev_data->stats = devm_alloc_percpu(&pdev->dev, simtemp_stats_pcpu_t);
+	if (!dev_data->stats) {
+		dev_err(&pdev->dev, "Cannot allocate statistics\n");
+		return -ENOMEM;
+	}
+	for_each_possible_cpu(cpu)
+		u64_stats_init(&per_cpu_ptr(dev_data->stats, cpu)->syncp);
+	atomic_set(&dev_data->readers, 0);
+
 	/* Initialize the data and config mutex */
 	mutex_init(&dev_data->data_mutex);
 	mutex_init(&dev_data->config_mutex);
 
 	/* Initialize wait_queue */
+	INIT_LIST_HEAD(&dev_data->readers_list);
 	init_waitqueue_head(&dev_data->data_wq);
+	init_waitqueue_head(&dev_data->read_wq);
+
+	/* Lowest free id, never one of a device still bound */
+	ret = ida_alloc_max(&simtemp_drv_data.device_ida, MAX_DEVICES - 1,
+			    GFP_KERNEL);
+	if (ret < 0) {
+		dev_err(&pdev->dev, "No free device number\n");
+		return ret;
+	}
 
 	/* Saving driver global data into specific device data */
 	dev_data->class_simtemp = simtemp_drv_data.class_simtemp;
-	dev_data->dev_num = simtemp_drv_data.device_num_base +
-			    simtemp_drv_data.total_devices;
+	dev_data->dev_num = simtemp_drv_data.device_num_base + ret;
+	dev_data->sensor_id = ret;
 
 	/* Save the device data in the platform device structure */
 	dev_set_drvdata(&pdev->dev, dev_data);
@@ -354,35 +1040,33 @@ int simtemp_platform_driver_probe(struct platform_device *pdev)
 	ret = cdev_add(&dev_data->cdev, dev_data->dev_num, 1);
 	if (ret < 0) {
 		dev_err(&pdev->dev, "Cdev add failed\n");
+		ida_free(&simtemp_drv_data.device_ida, dev_data->sensor_id);
 		return ret;
 	}
 
+	/*
+	 * Initialize the work queue for periodic callback before the sysfs
+	 * attributes exist: their stores re-arm it
+	 */
+	INIT_DELAYED_WORK(&dev_data->d_work, simtemp_work_handler);
+
 	/* Create device file and sysfs attributes */
 	dev_data->device_simtemp = device_create_with_groups(
 		dev_data->class_simtemp, &pdev->dev, dev_data->dev_num, NULL,
 		simtemp_sensor_groups,
-		(simtemp_drv_data.total_devices == 0) ? "simtemp" :
-							"simtemp-%d",
-		simtemp_drv_data.total_devices);
+		(dev_data->sensor_id == 0) ? "simtemp" : "simtemp-%u",
+		dev_data->sensor_id);
 	if (IS_ERR(dev_data->device_simtemp)) {
 		dev_err(&pdev->dev, "Device create failed\n");
 		ret = PTR_ERR(dev_data->device_simtemp);
 		cdev_del(&dev_data->cdev);
+		ida_free(&simtemp_drv_data.device_ida, dev_data->sensor_id);
 		return ret;
 	}
 
-	/* Initialize the work queue for periodic callback */
-	INIT_DELAYED_WORK(&dev_data->d_work, simtemp_work_handler);
-	if (!schedule_delayed_work(
-		    &dev_data->d_work,
-		    msecs_to_jiffies(dev_data->pdata.sampling_ms))) {
-		dev_err(&pdev->dev, "Schedule delayed work failed\n");
-		device_destroy(dev_data->class_simtemp, dev_data->dev_num);
-		cdev_del(&dev_data->cdev);
-		return -EPERM;
-	}
-
-	simtemp_drv_data.total_devices++;
+	/* Start sampling (a sysfs store may have armed it already) */
+	mod_delayed_work(system_wq, &dev_data->d_work,
+			 msecs_to_jiffies(dev_data->effective_sampling_ms));
 
 	dev_info(&pdev->dev, "Probe was successful\n");
 
@@ -394,16 +1078,20 @@ void simtemp_platform_driver_remove(struct platform_device *pdev)
 {
 	simtemp_dev_priv_data_t *dev_data = dev_get_drvdata(&pdev->dev);
 
+	/*
+	 * Remove a device that was created with device_create() first, so no
+	 * sysfs store can re-arm the callback once it is cancelled
+	 */
+	device_destroy(dev_data->class_simtemp, dev_data->dev_num);
+
 	/* Remove periodic callback */
 	cancel_delayed_work_sync(&dev_data->d_work);
 
-	/* Remove a device that was created with device_create() */
-	device_destroy(dev_data->class_simtemp, dev_data->dev_num);
-
 	/* Remove a cdev entry from the system*/
 	cdev_del(&dev_data->cdev);
 
-	simtemp_drv_data.total_devices--;
+	/* The id (and minor) can be reused by the next probe */
+	ida_free(&simtemp_drv_data.device_ida, dev_data->sensor_id);
 
 	dev_info(&pdev->dev, "A device is removed\n");
 }
@@ -445,6 +1133,16 @@ static int __init simtemp_platform_driver_init(void)
 		return ret;
 	}
 
+	/* Register the alert multicast channel */
+	ret = simtemp_genl_register();
+	if (ret < 0) {
+		pr_err("Generic netlink family registration failed\n");
+		class_destroy(simtemp_drv_data.class_simtemp);
+		unregister_chrdev_region(simtemp_drv_data.device_num_base,
+					 MAX_DEVICES);
+		return ret;
+	}
+
 	/* Register a platform driver */
 	platform_driver_register(&simtemp_platform_driver);
 
@@ -459,11 +1157,15 @@ static void __exit simtemp_platform_driver_cleanup(void)
 	/* Unregister the platform driver */
 	platform_driver_unregister(&simtemp_platform_driver);
 
+	/* Unregister the alert multicast channel */
+	simtemp_genl_unregister();
+
 	/* Class destroy */
 	class_destroy(simtemp_drv_data.class_simtemp);
 
 	/* Unregister device numbers */
 	unregister_chrdev_region(simtemp_drv_data.device_num_base, MAX_DEVICES);
+	ida_destroy(&simtemp_drv_data.device_ida);
 
 	pr_info("simtemp platform driver unloaded\n");
 }
@@ -8,24 +8,42 @@
 #include <linux/wait.h>
 #include <linux/fs.h>
 #include <linux/mutex.h>
+#include <linux/percpu.h>
+#include <linux/atomic.h>
+#include <linux/list.h>
+#include <linux/u64_stats_sync.h>
+#include <linux/bitmap.h>
+
+#include "nxp_simtemp_uapi.h"
+#include "ring_buff_helper.h"
 
 #undef pr_fmt
 #define pr_fmt(fmt) "%s : " fmt, __func__
 
 #define SIMTEMP_DEFAULT_SAMPLING_MS 500
 #define SIMTEMP_DEFAULT_THRESHOLD_MC 42000
+#define SIMTEMP_DEFAULT_MIN_SAMPLING_MS 10
+#define SIMTEMP_DEFAULT_MAX_SAMPLING_MS 5000
+
+/* Valid range for any sampling period (ms) */
+#define SIMTEMP_SAMPLING_MS_MIN 1
+#define SIMTEMP_SAMPLING_MS_MAX 50000
 
-#define TEMP_SAMPLE_BUF_SIZE 4
+/* Adaptive sampling tuning (milli-degree Celsius) */
+#define SIMTEMP_ADAPT_NEAR_MC 2000 // shrink the period closer than this
+#define SIMTEMP_ADAPT_FAR_MC 10000 // stretch the period farther than this
+#define SIMTEMP_ADAPT_STEEP_MC 500 // shrink the period on steps above this
+#define SIMTEMP_ADAPT_STABLE_MC 200 // stretch only on steps below this
 
-#define SIMTEMP_EVT_NEW 0x0001
-#define SIMTEMP_EVT_THRS 0x0002
+/* Samples staged on the stack per copy_to_user() chunk of a read() */
+#define SIMTEMP_READ_BATCH 16
 
-struct simtemp_sample {
-	__u64 timestamp_ns; // monotonic timestamp
-	__s32 temp_mC; // milli-degree Celsius (e.g., 44123 = 44.123 °C)
-	__u32 flags; // bit0=NEW_SAMPLE, bit1=THRESHOLD_CROSSED
-} __attribute__((packed));
-typedef struct simtemp_sample simtemp_sample_t;
+/* Burst generation */
+#define SIMTEMP_BURST_MAX 256 // samples per tick (Poisson trials)
+#define SIMTEMP_BURST_SPIKE_TICKS 10 // one spike every N ticks
+
+/* Channels of one device (one sample per channel and frame) */
+#define SIMTEMP_CHANNELS_MAX 64
 
 /* Simulated temperature mode */
 typedef enum simtemp_sample_mode {
@@ -34,31 +52,105 @@ typedef enum simtemp_sample_mode {
 	SIMTEMP_MODE_RAMP,
 } simtemp_sample_mode_e;
 
-/* Ring buffer struct */
-typedef struct simtemp_ring_buff {
-	simtemp_sample_t readings[TEMP_SAMPLE_BUF_SIZE];
-	unsigned int head; // next write position
-	unsigned int tail; // next read position
-} simtemp_ring_buff_t;
+/* Ring buffer overflow policy */
+typedef enum simtemp_ovf_policy {
+	SIMTEMP_OVF_OVERWRITE, // drop the oldest sample
+	SIMTEMP_OVF_DROP_NEWEST, // drop the incoming sample
+	SIMTEMP_OVF_BLOCK, // pause the generator until there is room
+} simtemp_ovf_policy_e;
+
+/* Samples generated per tick */
+typedef enum simtemp_burst_pattern {
+	SIMTEMP_BURST_OFF, // one sample per tick
+	SIMTEMP_BURST_STEADY, // burst_count samples every tick
+	SIMTEMP_BURST_SPIKES, // burst_count samples every SPIKE_TICKS ticks
+	SIMTEMP_BURST_POISSON, // Poisson arrivals, burst_count on average
+} simtemp_burst_pattern_e;
 
 /* Platform data of the simtemp */
 typedef struct simtemp_plat_data {
 	unsigned int sampling_ms;
 	int threshold_mC;
 	simtemp_sample_mode_e mode;
+	simtemp_ovf_policy_e overflow_policy;
+	bool adaptive; // stretch/shrink the period around the threshold
+	unsigned int min_sampling_ms; // adaptive lower bound
+	unsigned int max_sampling_ms; // adaptive upper bound
+	simtemp_burst_pattern_e burst_pattern;
+	unsigned int burst_count; // samples per burst (1..SIMTEMP_BURST_MAX)
+	unsigned int channels; // 0 means 1
+	const s32 *thresholds_mC; // optional, one per channel
 } simtemp_plat_data_t;
 
+/* Per-channel generator state, kept contiguous for the frame loop */
+typedef struct simtemp_channel {
+	int32_t temp_mC; // last generated temperature
+	int threshold_mC;
+	bool is_above; // last sample was above the threshold
+} simtemp_channel_t;
+
+/* Threshold crossings of a channel within one tick */
+typedef struct simtemp_edge {
+	simtemp_sample_t sample; // last crossing
+	int threshold_mC; // threshold it crossed
+	u32 count; // crossings coalesced into one alert
+} simtemp_edge_t;
+
+/* Per-CPU statistics, summed on demand (see simtemp_stats_snapshot()) */
+typedef struct simtemp_stats_pcpu {
+	u64_stats_t updates;
+	u64_stats_t alerts;
+	u64_stats_t overruns;
+	u64_stats_t reads;
+	u64_stats_t bytes;
+	u64_stats_t polls;
+	u64_stats_t wakeups;
+	struct u64_stats_sync syncp; // untorn 64-bit reads on 32-bit CPUs
+} simtemp_stats_pcpu_t;
+
+/*
+ * Add to a per-CPU counter of the device. Preemption is off during the
+ * update, so each CPU's sequence counter has a single writer.
+ */
+#define SIMTEMP_STATS_ADD(_p_dev_data, _field, _value)                  \
+	do {                                                            \
+		simtemp_stats_pcpu_t *_pcpu =                           \
+			get_cpu_ptr((_p_dev_data)->stats);              \
+		u64_stats_update_begin(&_pcpu->syncp);                  \
+		u64_stats_add(&_pcpu->_field, (_value));                \
+		u64_stats_update_end(&_pcpu->syncp);                    \
+		put_cpu_ptr((_p_dev_data)->stats);                      \
+	} while (0)
+
 /* Device private data structure */
 typedef struct simtemp_dev_priv_data {
 	simtemp_plat_data_t pdata;
 	simtemp_ring_buff_t *buffer;
 
-	/* Statistics (read-only) */
-	unsigned long update_count;
-	unsigned long alert_count;
+	/* Statistics (lock-free, per-CPU) */
+	simtemp_stats_pcpu_t __percpu *stats;
+	atomic_t readers; // open files that read or polled
+
+	/* Reading files, each with a ring cursor (protected by data_mutex) */
+	struct list_head readers_list;
+
+	/* Channels and alert state (protected by config_mutex) */
+	u32 sensor_id;
+	unsigned int n_channels;
+	simtemp_channel_t *channels;
+	simtemp_edge_t *edges; // crossings of each channel in a tick (worker only)
+
+	/* Adaptive sampling state (protected by config_mutex) */
+	unsigned int effective_sampling_ms;
+
+	/* Burst generation state (protected by config_mutex) */
+	u32 seq; // next sample sequence number
+	u64 last_timestamp_ns; // keeps synthetic timestamps monotonic
+	unsigned long tick;
 
 	struct delayed_work d_work;
-	wait_queue_head_t data_wq;
+	wait_queue_head_t data_wq; // pollers
+	wait_queue_head_t read_wq; // blocking readers (filtered wake up)
 	struct mutex data_mutex;
 	struct mutex config_mutex;
 
@@ -68,4 +160,20 @@ typedef struct simtemp_dev_priv_data {
 	struct device *device_simtemp;
 } simtemp_dev_priv_data_t;
 
+/* Per open file (reader) context */
+typedef struct simtemp_file_ctx {
+	simtemp_dev_priv_data_t *p_dev_data;
+
+	/* Ring cursor (protected by data_mutex), set up on first read/poll */
+	bool is_reader; // in readers_list
+	struct list_head node; // in readers_list
+	unsigned int tail; // next sample to deliver
+	bool gap_pending; // flag the next delivered sample with OVERRUN
+
+	/* Filter state (protected by data_mutex) */
+	struct simtemp_filter filter;
+	int32_t last_temp_mC[SIMTEMP_CHANNELS_MAX]; // last delivered (DELTA)
+	DECLARE_BITMAP(has_last_temp, SIMTEMP_CHANNELS_MAX);
+} simtemp_file_ctx_t;
+
 #endif
\ No newline at end of file
@@ -7,6 +7,7 @@ simtemp_plat_data_t *simtemp_dev_get_platdata_from_dt(struct device *dev)
 	struct device_node *np = dev->of_node;
 	simtemp_plat_data_t *pdata;
 	const char *mode_str;
+	s32 *thresholds;
 	int ret;
 
 	if (!np) {
@@ -48,5 +49,47 @@ simtemp_plat_data_t *simtemp_dev_get_platdata_from_dt(struct device *dev)
 		pdata->mode = SIMTEMP_MODE_NORMAL;
 	}
 
+	ret = of_property_read_string(np, "nxp,overflow-policy", &mode_str);
+	if (ret == 0 && strcmp(mode_str, "drop") == 0)
+		pdata->overflow_policy = SIMTEMP_OVF_DROP_NEWEST;
+	else if (ret == 0 && strcmp(mode_str, "block") == 0)
+		pdata->overflow_policy = SIMTEMP_OVF_BLOCK;
+	else
+		pdata->overflow_policy = SIMTEMP_OVF_OVERWRITE;
+
+	/* Adaptive sampling is optional (defaults applied at probe) */
+	pdata->adaptive = of_property_read_bool(np, "nxp,adaptive");
+	of_property_read_u32(np, "nxp,min-sampling-ms",
+			     &pdata->min_sampling_ms);
+	of_property_read_u32(np, "nxp,max-sampling-ms",
+			     &pdata->max_sampling_ms);
+
+	/* Burst generation is optional (one sample per tick by default) */
+	ret = of_property_read_string(np, "nxp,burst-pattern", &mode_str);
+	if (ret == 0 && strcmp(mode_str, "steady") == 0)
+		pdata->burst_pattern = SIMTEMP_BURST_STEADY;
+	else if (ret == 0 && strcmp(mode_str, "spikes") == 0)
+		pdata->burst_pattern = SIMTEMP_BURST_SPIKES;
+	else if (ret == 0 && strcmp(mode_str, "poisson") == 0)
+		pdata->burst_pattern = SIMTEMP_BURST_POISSON;
+	else
+		pdata->burst_pattern = SIMTEMP_BURST_OFF;
+	of_property_read_u32(np, "nxp,burst-count", &pdata->burst_count);
+
+	/* Multi-channel devices, optionally with one threshold per channel */
+	of_property_read_u32(np, "nxp,channels", &pdata->channels);
+	ret = of_property_count_u32_elems(np, "nxp,thresholds-mC");
+	if (ret > 0 && ret != (pdata->channels ?: 1)) {
+		dev_warn(dev, "thresholds-mC does not match channels (ignored)\n");
+	} else if (ret > 0) {
+		thresholds = devm_kcalloc(dev, ret, sizeof(*thresholds),
+					  GFP_KERNEL);
+		if (!thresholds)
+			return ERR_PTR(-ENOMEM);
+		of_property_read_u32_array(np, "nxp,thresholds-mC",
+					   (u32 *)thresholds, ret);
+		pdata->thresholds_mC = thresholds;
+	}
+
 	return pdata;
 }
@@ -0,0 +1,80 @@
+#include "nxp_simtemp_genl.h"
+#include <net/genetlink.h>
+
+/* Multicast group ids (index into simtemp_genl_mcgrps) */
+enum simtemp_genl_mcgrp_id {
+	SIMTEMP_GENL_MCGRP_ALERTS_ID,
+};
+
+static const struct genl_multicast_group simtemp_genl_mcgrps[] = {
+	[SIMTEMP_GENL_MCGRP_ALERTS_ID] = { .name = SIMTEMP_GENL_MCGRP_ALERTS },
+};
+
+/* Notification only family (no commands are accepted from user space) */
+static struct genl_family simtemp_genl_family = {
+	.name = SIMTEMP_GENL_NAME,
+	.version = SIMTEMP_GENL_VERSION,
+	.maxattr = SIMTEMP_GENL_A_MAX,
+	.module = THIS_MODULE,
+	.mcgrps = simtemp_genl_mcgrps,
+	.n_mcgrps = ARRAY_SIZE(simtemp_genl_mcgrps),
+};
+
+int simtemp_genl_register(void)
+{
+	return genl_register_family(&simtemp_genl_family);
+}
+
+void simtemp_genl_unregister(void)
+{
+	genl_unregister_family(&simtemp_genl_family);
+}
+
+/*
+ * Multicast the last threshold crossing of a channel in a tick, along with
+ * the number of crossings it stands for (process context)
+ */
+void simtemp_genl_notify_alert(u32 sensor_id, simtemp_sample_t *sample,
+			       int threshold_mC, bool rising, u32 n_edges)
+{
+	struct sk_buff *skb;
+	void *hdr;
+
+	/* Skip the allocation when nobody is subscribed */
+	if (!genl_has_listeners(&simtemp_genl_family, &init_net,
+				SIMTEMP_GENL_MCGRP_ALERTS_ID))
+		return;
+
+	skb = genlmsg_new(3 * nla_total_size(sizeof(u32)) +
+				  nla_total_size_64bit(sizeof(u64)) +
+				  2 * nla_total_size(sizeof(s32)) +
+				  nla_total_size(sizeof(u8)),
+			  GFP_KERNEL);
+	if (!skb)
+		return;
+
+	hdr = genlmsg_put(skb, 0, 0, &simtemp_genl_family, 0,
+			  SIMTEMP_GENL_CMD_ALERT);
+	if (!hdr)
+		goto err_free;
+
+	if (nla_put_u32(skb, SIMTEMP_GENL_A_SENSOR_ID, sensor_id) ||
+	    nla_put_u64_64bit(skb, SIMTEMP_GENL_A_TIMESTAMP_NS,
+			      sample->timestamp_ns, SIMTEMP_GENL_A_PAD) ||
+	    nla_put_s32(skb, SIMTEMP_GENL_A_TEMP_MC, sample->temp_mC) ||
+	    nla_put_s32(skb, SIMTEMP_GENL_A_THRESHOLD_MC, threshold_mC) ||
+	    nla_put_u8(skb, SIMTEMP_GENL_A_RISING, rising) ||
+	    nla_put_u32(skb, SIMTEMP_GENL_A_CHANNEL, sample->channel) ||
+	    nla_put_u32(skb, SIMTEMP_GENL_A_EDGES, n_edges))
+		goto err_free;
+
+	genlmsg_end(skb, hdr);
+
+	/* Consumes the skb (ESRCH only means no listeners left) */
+	genlmsg_multicast(&simtemp_genl_family, skb, 0,
+			  SIMTEMP_GENL_MCGRP_ALERTS_ID, GFP_KERNEL);
+	return;
+
+err_free:
+	nlmsg_free(skb);
+}
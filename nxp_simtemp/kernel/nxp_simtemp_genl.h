@@ -0,0 +1,13 @@
+#ifndef NXP_SIMTEMP_GENL_H
+#define NXP_SIMTEMP_GENL_H
+
+#include "nxp_simtemp.h"
+
+int simtemp_genl_register(void);
+
+void simtemp_genl_unregister(void);
+
+void simtemp_genl_notify_alert(u32 sensor_id, simtemp_sample_t *sample,
+			       int threshold_mC, bool rising, u32 n_edges);
+
+#endif
@@ -1,5 +1,27 @@
 #include "nxp_simtemp_sysfs_iface.h"
 #include "nxp_simtemp.h"
+#include <linux/slab.h>
+#include <linux/string.h>
+
+/*
+ * Recompute the effective period after a config change and move the pending
+ * callback to it. Must be called with config_mutex held; mod_delayed_work()
+ * does not wait for a running handler (which takes config_mutex itself).
+ */
+static void simtemp_update_period(simtemp_dev_priv_data_t *p_dev_data)
+{
+	simtemp_plat_data_t *pdata = &p_dev_data->pdata;
+
+	if (pdata->adaptive)
+		p_dev_data->effective_sampling_ms =
+			clamp(p_dev_data->effective_sampling_ms,
+			      pdata->min_sampling_ms, pdata->max_sampling_ms);
+	else
+		p_dev_data->effective_sampling_ms = pdata->sampling_ms;
+
+	mod_delayed_work(system_wq, &p_dev_data->d_work,
+			 msecs_to_jiffies(p_dev_data->effective_sampling_ms));
+}
 
 ssize_t sampling_ms_show(struct device *dev,
 				 struct device_attribute *attr, char *buf)
@@ -37,20 +59,19 @@ ssize_t sampling_ms_store(struct device *dev,
 	if (ret)
 		return ret;
 
-	if (new_period < 1 || new_period > 50000) /* Validate the range */
+	/* Validate the range */
+	if (new_period < SIMTEMP_SAMPLING_MS_MIN ||
+	    new_period > SIMTEMP_SAMPLING_MS_MAX)
 		return -EINVAL;
 
 	mutex_lock(&p_dev_data->config_mutex);
 
-	/* First cancel the callback */
-	cancel_delayed_work_sync(&p_dev_data->d_work);
-
-	/* Update the sampling period */
+	/* Update the sampling period (adaptive mode restarts from it) */
 	p_dev_data->pdata.sampling_ms = new_period;
+	p_dev_data->effective_sampling_ms = new_period;
 
 	/* Reschedule callback */
-	schedule_delayed_work(&p_dev_data->d_work,
-			      msecs_to_jiffies(new_period));
+	simtemp_update_period(p_dev_data);
 
 	mutex_unlock(&p_dev_data->config_mutex);
 
@@ -83,6 +104,7 @@ ssize_t threshold_mc_store(struct device *dev,
 {
 	int ret;
 	int new_threshold;
+	unsigned int i;
 	simtemp_dev_priv_data_t *p_dev_data = dev_get_drvdata(dev->parent);
 	if (!p_dev_data) {
 		dev_err(dev->parent, "No device data available\n");
@@ -95,8 +117,10 @@ ssize_t threshold_mc_store(struct device *dev,
 
 	mutex_lock(&p_dev_data->config_mutex);
 
-	/* Update the threshold */
+	/* Update the threshold (of every channel) */
 	p_dev_data->pdata.threshold_mC = new_threshold;
+	for (i = 0; i < p_dev_data->n_channels; i++)
+		p_dev_data->channels[i].threshold_mC = new_threshold;
 
 	mutex_unlock(&p_dev_data->config_mutex);
 
@@ -163,8 +187,90 @@ ssize_t mode_store(struct device *dev, struct device_attribute *attr,
 	return count;
 }
 
+/*
+ * Sum the per-CPU counters. Lock-free, so the snapshot is not atomic across
+ * counters, but each one is monotonic.
+ */
+void simtemp_stats_snapshot(simtemp_dev_priv_data_t *p_dev_data,
+			    struct simtemp_stats *stats)
+{
+	int cpu;
+
+	memset(stats, 0, sizeof(*stats));
+
+	for_each_possible_cpu(cpu) {
+		simtemp_stats_pcpu_t *pcpu = per_cpu_ptr(p_dev_data->stats, cpu);
+		u64 updates, alerts, overruns, reads, bytes, polls, wakeups;
+		unsigned int start;
+
+		/* Retry if this CPU updated its counters meanwhile (32-bit) */
+		do {
+			start = u64_stats_fetch_begin(&pcpu->syncp);
+			updates = u64_stats_read(&pcpu->updates);
+			alerts = u64_stats_read(&pcpu->alerts);
+			overruns = u64_stats_read(&pcpu->overruns);
+			reads = u64_stats_read(&pcpu->reads);
+			bytes = u64_stats_read(&pcpu->bytes);
+			polls = u64_stats_read(&pcpu->polls);
+			wakeups = u64_stats_read(&pcpu->wakeups);
+		} while (u64_stats_fetch_retry(&pcpu->syncp, start));
+
+		stats->updates += updates;
+		stats->alerts += alerts;
+		stats->overruns += overruns;
+		stats->reads += reads;
+		stats->bytes += bytes;
+		stats->polls += polls;
+		stats->wakeups += wakeups;
+	}
+
+	stats->readers = atomic_read(&p_dev_data->readers);
+}
+
 ssize_t stats_show(struct device *dev, struct device_attribute *attr,
 			   char *buf)
+{
+	struct simtemp_stats stats;
+	simtemp_dev_priv_data_t *p_dev_data = dev_get_drvdata(dev->parent);
+	if (!p_dev_data) {
+		dev_err(dev->parent, "No device data available\n");
+		return -EINVAL;
+	}
+
+	simtemp_stats_snapshot(p_dev_data, &stats);
+
+	// Use snprintf to safely format the data into the output buffer
+	return snprintf(buf, PAGE_SIZE,
+			"N of updates: %llu, N of alerts: %llu, N of overruns: %llu\n",
+			stats.updates, stats.alerts, stats.overruns);
+}
+
+/* statistics/<counter> attributes, one value per file */
+#define SIMTEMP_STAT_SHOW(_name)                                               \
+	ssize_t _name##_show(struct device *dev,                               \
+			     struct device_attribute *attr, char *buf)         \
+	{                                                                      \
+		struct simtemp_stats stats;                                    \
+		simtemp_dev_priv_data_t *p_dev_data =                          \
+			dev_get_drvdata(dev->parent);                          \
+		if (!p_dev_data)                                               \
+			return -EINVAL;                                        \
+                                                                               \
+		simtemp_stats_snapshot(p_dev_data, &stats);                    \
+		return snprintf(buf, PAGE_SIZE, "%llu\n", (u64)stats._name);   \
+	}
+
+SIMTEMP_STAT_SHOW(updates)
+SIMTEMP_STAT_SHOW(alerts)
+SIMTEMP_STAT_SHOW(overruns)
+SIMTEMP_STAT_SHOW(reads)
+SIMTEMP_STAT_SHOW(bytes)
+SIMTEMP_STAT_SHOW(polls)
+SIMTEMP_STAT_SHOW(wakeups)
+SIMTEMP_STAT_SHOW(readers)
+
+ssize_t adaptive_show(struct device *dev, struct device_attribute *attr,
+		      char *buf)
 {
 	int ret;
 	simtemp_dev_priv_data_t *p_dev_data = dev_get_drvdata(dev->parent);
@@ -175,11 +281,405 @@ ssize_t stats_show(struct device *dev, struct device_attribute *attr,
 
 	mutex_lock(&p_dev_data->config_mutex);
 
-	// Use snprintf to safely format the data into the output buffer
-	ret = snprintf(buf, PAGE_SIZE, "N of updates: %lu, N of alerts: %lu\n",
-		       p_dev_data->update_count, p_dev_data->alert_count);
+	ret = snprintf(buf, PAGE_SIZE, "%d\n", p_dev_data->pdata.adaptive);
+
+	mutex_unlock(&p_dev_data->config_mutex);
+
+	return ret;
+}
+
+ssize_t adaptive_store(struct device *dev, struct device_attribute *attr,
+		       const char *buf, size_t count)
+{
+	int ret;
+	bool enable;
+	simtemp_dev_priv_data_t *p_dev_data = dev_get_drvdata(dev->parent);
+	if (!p_dev_data) {
+		dev_err(dev->parent, "No device data available\n");
+		return -EINVAL;
+	}
+
+	ret = kstrtobool(buf, &enable);
+	if (ret)
+		return ret;
+
+	mutex_lock(&p_dev_data->config_mutex);
+
+	/* Adaptive mode starts from the configured period */
+	p_dev_data->pdata.adaptive = enable;
+	p_dev_data->effective_sampling_ms = p_dev_data->pdata.sampling_ms;
+	simtemp_update_period(p_dev_data);
+
+	mutex_unlock(&p_dev_data->config_mutex);
+
+	return count;
+}
+
+ssize_t min_sampling_ms_show(struct device *dev,
+			     struct device_attribute *attr, char *buf)
+{
+	int ret;
+	simtemp_dev_priv_data_t *p_dev_data = dev_get_drvdata(dev->parent);
+	if (!p_dev_data) {
+		dev_err(dev->parent, "No device data available\n");
+		return -EINVAL;
+	}
+
+	mutex_lock(&p_dev_data->config_mutex);
+
+	ret = snprintf(buf, PAGE_SIZE, "%u\n",
+		       p_dev_data->pdata.min_sampling_ms);
+
+	mutex_unlock(&p_dev_data->config_mutex);
+
+	return ret;
+}
+
+ssize_t min_sampling_ms_store(struct device *dev,
+			      struct device_attribute *attr, const char *buf,
+			      size_t count)
+{
+	int ret;
+	unsigned int new_min;
+	simtemp_dev_priv_data_t *p_dev_data = dev_get_drvdata(dev->parent);
+	if (!p_dev_data) {
+		dev_err(dev->parent, "No device data available\n");
+		return -EINVAL;
+	}
+
+	ret = kstrtouint(buf, 10, &new_min);
+	if (ret)
+		return ret;
+
+	if (new_min < SIMTEMP_SAMPLING_MS_MIN ||
+	    new_min > SIMTEMP_SAMPLING_MS_MAX)
+		return -EINVAL;
+
+	mutex_lock(&p_dev_data->config_mutex);
+
+	/* The bounds must stay ordered */
+	if (new_min > p_dev_data->pdata.max_sampling_ms) {
+		mutex_unlock(&p_dev_data->config_mutex);
+		return -EINVAL;
+	}
+
+	p_dev_data->pdata.min_sampling_ms = new_min;
+	simtemp_update_period(p_dev_data);
+
+	mutex_unlock(&p_dev_data->config_mutex);
+
+	return count;
+}
+
+ssize_t max_sampling_ms_show(struct device *dev,
+			     struct device_attribute *attr, char *buf)
+{
+	int ret;
+	simtemp_dev_priv_data_t *p_dev_data = dev_get_drvdata(dev->parent);
+	if (!p_dev_data) {
+		dev_err(dev->parent, "No device data available\n");
+		return -EINVAL;
+	}
+
+	mutex_lock(&p_dev_data->config_mutex);
+
+	ret = snprintf(buf, PAGE_SIZE, "%u\n",
+		       p_dev_data->pdata.max_sampling_ms);
+
+	mutex_unlock(&p_dev_data->config_mutex);
+
+	return ret;
+}
+
+ssize_t max_sampling_ms_store(struct device *dev,
+			      struct device_attribute *attr, const char *buf,
+			      size_t count)
+{
+	int ret;
+	unsigned int new_max;
+	simtemp_dev_priv_data_t *p_dev_data = dev_get_drvdata(dev->parent);
+	if (!p_dev_data) {
+		dev_err(dev->parent, "No device data available\n");
+		return -EINVAL;
+	}
+
+	ret = kstrtouint(buf, 10, &new_max);
+	if (ret)
+		return ret;
+
+	if (new_max < SIMTEMP_SAMPLING_MS_MIN ||
+	    new_max > SIMTEMP_SAMPLING_MS_MAX)
+		return -EINVAL;
+
+	mutex_lock(&p_dev_data->config_mutex);
+
+	/* The bounds must stay ordered */
+	if (new_max < p_dev_data->pdata.min_sampling_ms) {
+		mutex_unlock(&p_dev_data->config_mutex);
+		return -EINVAL;
+	}
+
+	p_dev_data->pdata.max_sampling_ms = new_max;
+	simtemp_update_period(p_dev_data);
+
+	mutex_unlock(&p_dev_data->config_mutex);
+
+	return count;
+}
+
+ssize_t effective_sampling_ms_show(struct device *dev,
+				   struct device_attribute *attr, char *buf)
+{
+	int ret;
+	simtemp_dev_priv_data_t *p_dev_data = dev_get_drvdata(dev->parent);
+	if (!p_dev_data) {
+		dev_err(dev->parent, "No device data available\n");
+		return -EINVAL;
+	}
+
+	mutex_lock(&p_dev_data->config_mutex);
+
+	ret = snprintf(buf, PAGE_SIZE, "%u\n",
+		       p_dev_data->effective_sampling_ms);
+
+	mutex_unlock(&p_dev_data->config_mutex);
+
+	return ret;
+}
+
+static const char *overflow_policy_strings[] = {
+	[SIMTEMP_OVF_OVERWRITE] = "overwrite",
+	[SIMTEMP_OVF_DROP_NEWEST] = "drop",
+	[SIMTEMP_OVF_BLOCK] = "block",
+};
+
+ssize_t overflow_policy_show(struct device *dev,
+			     struct device_attribute *attr, char *buf)
+{
+	int ret;
+	simtemp_dev_priv_data_t *p_dev_data = dev_get_drvdata(dev->parent);
+	if (!p_dev_data) {
+		dev_err(dev->parent, "No device data available\n");
+		return -EINVAL;
+	}
+
+	mutex_lock(&p_dev_data->config_mutex);
+
+	ret = snprintf(buf, PAGE_SIZE, "%s\n",
+		       overflow_policy_strings[p_dev_data->pdata.overflow_policy]);
 
 	mutex_unlock(&p_dev_data->config_mutex);
 
 	return ret;
 }
+
+ssize_t overflow_policy_store(struct device *dev,
+			      struct device_attribute *attr, const char *buf,
+			      size_t count)
+{
+	int index;
+	simtemp_dev_priv_data_t *p_dev_data = dev_get_drvdata(dev->parent);
+	if (!p_dev_data) {
+		dev_err(dev->parent, "No device data available\n");
+		return -EINVAL;
+	}
+
+	/* Compare input string with each policy */
+	index = sysfs_match_string(overflow_policy_strings, buf);
+	if (index < 0)
+		return index;
+
+	mutex_lock(&p_dev_data->config_mutex);
+
+	/* Update the policy */
+	p_dev_data->pdata.overflow_policy = index;
+
+	mutex_unlock(&p_dev_data->config_mutex);
+
+	return count;
+}
+
+static const char *burst_pattern_strings[] = {
+	[SIMTEMP_BURST_OFF] = "off",
+	[SIMTEMP_BURST_STEADY] = "steady",
+	[SIMTEMP_BURST_SPIKES] = "spikes",
+	[SIMTEMP_BURST_POISSON] = "poisson",
+};
+
+ssize_t burst_pattern_show(struct device *dev, struct device_attribute *attr,
+			   char *buf)
+{
+	int ret;
+	simtemp_dev_priv_data_t *p_dev_data = dev_get_drvdata(dev->parent);
+	if (!p_dev_data) {
+		dev_err(dev->parent, "No device data available\n");
+		return -EINVAL;
+	}
+
+	mutex_lock(&p_dev_data->config_mutex);
+
+	ret = snprintf(buf, PAGE_SIZE, "%s\n",
+		       burst_pattern_strings[p_dev_data->pdata.burst_pattern]);
+
+	mutex_unlock(&p_dev_data->config_mutex);
+
+	return ret;
+}
+
+ssize_t burst_pattern_store(struct device *dev, struct device_attribute *attr,
+			    const char *buf, size_t count)
+{
+	int index;
+	simtemp_dev_priv_data_t *p_dev_data = dev_get_drvdata(dev->parent);
+	if (!p_dev_data) {
+		dev_err(dev->parent, "No device data available\n");
+		return -EINVAL;
+	}
+
+	index = sysfs_match_string(burst_pattern_strings, buf);
+	if (index < 0)
+		return index;
+
+	mutex_lock(&p_dev_data->config_mutex);
+
+	p_dev_data->pdata.burst_pattern = index;
+	p_dev_data->tick = 0;
+
+	mutex_unlock(&p_dev_data->config_mutex);
+
+	return count;
+}
+
+ssize_t burst_count_show(struct device *dev, struct device_attribute *attr,
+			 char *buf)
+{
+	int ret;
+	simtemp_dev_priv_data_t *p_dev_data = dev_get_drvdata(dev->parent);
+	if (!p_dev_data) {
+		dev_err(dev->parent, "No device data available\n");
+		return -EINVAL;
+	}
+
+	mutex_lock(&p_dev_data->config_mutex);
+
+	ret = snprintf(buf, PAGE_SIZE, "%u\n", p_dev_data->pdata.burst_count);
+
+	mutex_unlock(&p_dev_data->config_mutex);
+
+	return ret;
+}
+
+ssize_t burst_count_store(struct device *dev, struct device_attribute *attr,
+			  const char *buf, size_t count)
+{
+	int ret;
+	unsigned int new_count;
+	simtemp_dev_priv_data_t *p_dev_data = dev_get_drvdata(dev->parent);
+	if (!p_dev_data) {
+		dev_err(dev->parent, "No device data available\n");
+		return -EINVAL;
+	}
+
+	ret = kstrtouint(buf, 10, &new_count);
+	if (ret)
+		return ret;
+
+	/* Bursts must fit twice in the ring buffer */
+	if (new_count < 1 || new_count > SIMTEMP_BURST_MAX)
+		return -EINVAL;
+
+	mutex_lock(&p_dev_data->config_mutex);
+
+	p_dev_data->pdata.burst_count = new_count;
+
+	mutex_unlock(&p_dev_data->config_mutex);
+
+	return count;
+}
+
+ssize_t channels_show(struct device *dev, struct device_attribute *attr,
+		      char *buf)
+{
+	simtemp_dev_priv_data_t *p_dev_data = dev_get_drvdata(dev->parent);
+	if (!p_dev_data) {
+		dev_err(dev->parent, "No device data available\n");
+		return -EINVAL;
+	}
+
+	/* Fixed at probe time */
+	return snprintf(buf, PAGE_SIZE, "%u\n", p_dev_data->n_channels);
+}
+
+ssize_t thresholds_mc_show(struct device *dev, struct device_attribute *attr,
+			   char *buf)
+{
+	int ret = 0;
+	unsigned int i;
+	simtemp_dev_priv_data_t *p_dev_data = dev_get_drvdata(dev->parent);
+	if (!p_dev_data) {
+		dev_err(dev->parent, "No device data available\n");
+		return -EINVAL;
+	}
+
+	mutex_lock(&p_dev_data->config_mutex);
+
+	/* One value per channel, space separated */
+	for (i = 0; i < p_dev_data->n_channels; i++)
+		ret += scnprintf(buf + ret, PAGE_SIZE - ret, "%s%d",
+				 i ? " " : "",
+				 p_dev_data->channels[i].threshold_mC);
+	ret += scnprintf(buf + ret, PAGE_SIZE - ret, "\n");
+
+	mutex_unlock(&p_dev_data->config_mutex);
+
+	return ret;
+}
+
+ssize_t thresholds_mc_store(struct device *dev, struct device_attribute *attr,
+			    const char *buf, size_t count)
+{
+	int ret = 0;
+	unsigned int n = 0;
+	int new_thresholds[SIMTEMP_CHANNELS_MAX];
+	char *copy, *cursor, *token;
+	simtemp_dev_priv_data_t *p_dev_data = dev_get_drvdata(dev->parent);
+	if (!p_dev_data) {
+		dev_err(dev->parent, "No device data available\n");
+		return -EINVAL;
+	}
+
+	copy = kstrndup(buf, count, GFP_KERNEL);
+	if (!copy)
+		return -ENOMEM;
+
+	/* Space separated values, from channel 0 (missing ones are kept) */
+	cursor = copy;
+	while ((token = strsep(&cursor, " \t\n")) != NULL) {
+		if (!*token)
+			continue;
+		if (n == p_dev_data->n_channels) {
+			ret = -EINVAL;
+			break;
+		}
+		ret = kstrtoint(token, 10, &new_thresholds[n]);
+		if (ret)
+			break;
+		n++;
+	}
+	kfree(copy);
+
+	if (ret)
+		return ret;
+	if (!n)
+		return -EINVAL;
+
+	mutex_lock(&p_dev_data->config_mutex);
+
+	while (n--)
+		p_dev_data->channels[n].threshold_mC = new_thresholds[n];
+	p_dev_data->pdata.threshold_mC = p_dev_data->channels[0].threshold_mC;
+
+	mutex_unlock(&p_dev_data->config_mutex);
+
+	return count;
+}
@@ -3,6 +3,8 @@
 
 #include <linux/device.h>
 
+#include "nxp_simtemp.h"
+
 ssize_t sampling_ms_show(struct device *dev,
 				 struct device_attribute *attr, char *buf);
 
@@ -26,4 +28,83 @@ ssize_t mode_store(struct device *dev, struct device_attribute *attr,
 ssize_t stats_show(struct device *dev, struct device_attribute *attr,
 			   char *buf);
 
+/* Lock-free sum of the per-CPU statistics */
+void simtemp_stats_snapshot(simtemp_dev_priv_data_t *p_dev_data,
+			    struct simtemp_stats *stats);
+
+ssize_t updates_show(struct device *dev, struct device_attribute *attr,
+		     char *buf);
+
+ssize_t alerts_show(struct device *dev, struct device_attribute *attr,
+		    char *buf);
+
+ssize_t overruns_show(struct device *dev, struct device_attribute *attr,
+		      char *buf);
+
+ssize_t reads_show(struct device *dev, struct device_attribute *attr,
+		   char *buf);
+
+ssize_t bytes_show(struct device *dev, struct device_attribute *attr,
+		   char *buf);
+
+ssize_t polls_show(struct device *dev, struct device_attribute *attr,
+		   char *buf);
+
+ssize_t wakeups_show(struct device *dev, struct device_attribute *attr,
+		     char *buf);
+
+ssize_t readers_show(struct device *dev, struct device_attribute *attr,
+		     char *buf);
+
+ssize_t adaptive_show(struct device *dev, struct device_attribute *attr,
+		      char *buf);
+
+ssize_t adaptive_store(struct device *dev, struct device_attribute *attr,
+		       const char *buf, size_t count);
+
+ssize_t min_sampling_ms_show(struct device *dev,
+			     struct device_attribute *attr, char *buf);
+
+ssize_t min_sampling_ms_store(struct device *dev,
+			      struct device_attribute *attr, const char *buf,
+			      size_t count);
+
+ssize_t max_sampling_ms_show(struct device *dev,
+			     struct device_attribute *attr, char *buf);
+
+ssize_t max_sampling_ms_store(struct device *dev,
+			      struct device_attribute *attr, const char *buf,
+			      size_t count);
+
+ssize_t effective_sampling_ms_show(struct device *dev,
+				   struct device_attribute *attr, char *buf);
+
+ssize_t overflow_policy_show(struct device *dev,
+			     struct device_attribute *attr, char *buf);
+
+ssize_t overflow_policy_store(struct device *dev,
+			      struct device_attribute *attr, const char *buf,
+			      size_t count);
+
+ssize_t burst_pattern_show(struct device *dev, struct device_attribute *attr,
+			   char *buf);
+
+ssize_t burst_pattern_store(struct device *dev, struct device_attribute *attr,
+			    const char *buf, size_t count);
+
+ssize_t burst_count_show(struct device *dev, struct device_attribute *attr,
+			 char *buf);
+
+ssize_t burst_count_store(struct device *dev, struct device_attribute *attr,
+			  const char *buf, size_t count);
+
+ssize_t channels_show(struct device *dev, struct device_attribute *attr,
+		      char *buf);
+
+ssize_t thresholds_mc_show(struct device *dev, struct device_attribute *attr,
+			   char *buf);
+
+ssize_t thresholds_mc_store(struct device *dev, struct device_attribute *attr,
+			    const char *buf, size_t count);
+
 #endif
@@ -0,0 +1,85 @@
+#ifndef NXP_SIMTEMP_UAPI_H
+#define NXP_SIMTEMP_UAPI_H
+
+/*
+** User visible ABI of the simtemp character device (shared with user space)
+*/
+#include <linux/types.h>
+#include <linux/ioctl.h>
+
+#define SIMTEMP_EVT_NEW 0x0001
+#define SIMTEMP_EVT_THRS 0x0002
+#define SIMTEMP_EVT_OVERRUN 0x0004 // samples were lost right before this one
+
+struct simtemp_sample {
+	__u64 timestamp_ns; // monotonic timestamp
+	__s32 temp_mC; // milli-degree Celsius (e.g., 44123 = 44.123 °C)
+	__u32 flags; // bit0=NEW_SAMPLE, bit1=THRESHOLD_CROSSED, bit2=OVERRUN
+	__u32 seq; // per device frame sequence number (gaps = lost frames)
+	__u32 channel; // channel of a multi-channel device (0 otherwise)
+} __attribute__((packed));
+typedef struct simtemp_sample simtemp_sample_t;
+
+/* Per-fd sample filter type */
+typedef enum simtemp_filter_type {
+	SIMTEMP_FILTER_NONE, // every sample
+	SIMTEMP_FILTER_BAND, // samples outside [low_mC, high_mC]
+	SIMTEMP_FILTER_DELTA, // changes >= delta_mC since the last delivered one
+	SIMTEMP_FILTER_DECIMATE, // every Nth generated sample
+	SIMTEMP_FILTER_FLAGS, // samples with any bit of flags_mask set
+} simtemp_filter_type_e;
+
+/* Per-fd sample filter (SIMTEMP_IOC_SET_FILTER / SIMTEMP_IOC_GET_FILTER) */
+struct simtemp_filter {
+	__u32 type; // simtemp_filter_type_e
+	__s32 low_mC;
+	__s32 high_mC;
+	__u32 delta_mC;
+	__u32 decimation;
+	__u32 flags_mask;
+};
+
+/* Device statistics snapshot (SIMTEMP_IOC_GET_STATS) */
+struct simtemp_stats {
+	__u64 updates; // samples generated
+	__u64 alerts; // samples above the threshold
+	__u64 overruns; // samples lost to a full ring
+	__u64 reads; // read() calls that returned data
+	__u64 bytes; // bytes delivered by read()
+	__u64 polls; // poll() calls
+	__u64 wakeups; // sleeping readers/pollers woken up
+	__u32 readers; // open files that have read or polled
+	__u32 reserved;
+};
+
+#define SIMTEMP_IOC_MAGIC 's'
+#define SIMTEMP_IOC_SET_FILTER _IOW(SIMTEMP_IOC_MAGIC, 1, struct simtemp_filter)
+#define SIMTEMP_IOC_GET_FILTER _IOR(SIMTEMP_IOC_MAGIC, 2, struct simtemp_filter)
+#define SIMTEMP_IOC_GET_STATS _IOR(SIMTEMP_IOC_MAGIC, 3, struct simtemp_stats)
+
+/* Generic netlink family multicasting threshold crossings */
+#define SIMTEMP_GENL_NAME "simtemp"
+#define SIMTEMP_GENL_VERSION 1
+#define SIMTEMP_GENL_MCGRP_ALERTS "alerts"
+
+enum simtemp_genl_cmd {
+	SIMTEMP_GENL_CMD_UNSPEC,
+	SIMTEMP_GENL_CMD_ALERT, // threshold crossed (either direction)
+	__SIMTEMP_GENL_CMD_MAX,
+};
+
+enum simtemp_genl_attr {
+	SIMTEMP_GENL_A_UNSPEC,
+	SIMTEMP_GENL_A_PAD,
+	SIMTEMP_GENL_A_SENSOR_ID, // u32, device index (simtemp-<id>)
+	SIMTEMP_GENL_A_TIMESTAMP_NS, // u64
+	SIMTEMP_GENL_A_TEMP_MC, // s32
+	SIMTEMP_GENL_A_THRESHOLD_MC, // s32
+	SIMTEMP_GENL_A_RISING, // u8, 1=went above threshold, 0=went back below
+	SIMTEMP_GENL_A_CHANNEL, // u32, channel within the device
+	SIMTEMP_GENL_A_EDGES, // u32, crossings in the tick (>1: coalesced)
+	__SIMTEMP_GENL_A_MAX,
+};
+#define SIMTEMP_GENL_A_MAX (__SIMTEMP_GENL_A_MAX - 1)
+
+#endif
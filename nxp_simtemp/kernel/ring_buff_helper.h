@@ -1,17 +1,136 @@
 #ifndef RING_BUFF_HELPER_H
 #define RING_BUFF_HELPER_H
 
-#include "nxp_simtemp.h"
+/*
+** Header-only sample ring buffer, built into the driver and into user-space
+** tools (benchmarks). No locking: callers serialize access.
+*/
+#ifdef __KERNEL__
+#include <linux/types.h>
+#else
+#include <stdbool.h>
+#endif
+
+#include "nxp_simtemp_uapi.h"
+
+/*
+ * Must be a power of two (indexes are free running counters). Twice the
+ * largest burst, so one burst never overwrites the previous one.
+ */
+#define TEMP_SAMPLE_BUF_SIZE 512
+
+#if (TEMP_SAMPLE_BUF_SIZE & (TEMP_SAMPLE_BUF_SIZE - 1)) != 0
+#error "TEMP_SAMPLE_BUF_SIZE must be a power of two"
+#endif
+
+/* Ring buffer struct */
+typedef struct simtemp_ring_buff {
+	simtemp_sample_t readings[TEMP_SAMPLE_BUF_SIZE];
+	unsigned int head; // samples ever written (wraps)
+	unsigned int tail; // samples ever read or dropped (wraps)
+	bool gap_pending; // flag the next stored sample with OVERRUN
+} simtemp_ring_buff_t;
+
+static inline unsigned int rb_index(unsigned int pos)
+{
+	return pos & (TEMP_SAMPLE_BUF_SIZE - 1);
+}
+
+/* head - tail is the fill level, so full and empty never alias */
+static inline unsigned int rb_count(const simtemp_ring_buff_t *rb)
+{
+	return rb->head - rb->tail;
+}
+
+static inline bool rb_is_empty(const simtemp_ring_buff_t *rb)
+{
+	return rb->head == rb->tail;
+}
+
+static inline bool rb_is_full(const simtemp_ring_buff_t *rb)
+{
+	return rb_count(rb) == TEMP_SAMPLE_BUF_SIZE;
+}
+
+/* Forget the oldest sample (cursors left behind it account for the loss) */
+static inline void rb_drop_oldest(simtemp_ring_buff_t *rb)
+{
+	if (!rb_is_empty(rb))
+		rb->tail++;
+}
 
 /*
-** Function Prototypes
+ * Store a sample. When the buffer is full either the oldest sample is
+ * dropped or the new one is discarded. Returns true if a sample was lost.
+ * A discarded sample flags the next stored one with SIMTEMP_EVT_OVERRUN
+ * (every reader missed it); a dropped oldest one is only missed by the
+ * cursors still on it, see rb_cursor_sync().
+ */
+static inline bool rb_put(simtemp_ring_buff_t *rb,
+			  const simtemp_sample_t *value, bool overwrite)
+{
+	simtemp_sample_t *slot;
+	bool lost = false;
+
+	if (rb_is_full(rb)) {
+		if (!overwrite) {
+			rb->gap_pending = true;
+			return true;
+		}
+
+		rb_drop_oldest(rb);
+		lost = true;
+	}
+
+	slot = &rb->readings[rb_index(rb->head)];
+	*slot = *value;
+	if (rb->gap_pending) {
+		slot->flags |= SIMTEMP_EVT_OVERRUN;
+		rb->gap_pending = false;
+	}
+	rb->head++;
+
+	return lost;
+}
+
+/*
+** Reader cursors: several readers walk the same ring, each from its own free
+** running position. The tail is then the oldest sample any reader still
+** needs, and a cursor left behind it has lost the samples in between.
 */
-void rb_put(simtemp_ring_buff_t *rb, simtemp_sample_t *value);
 
-int rb_get(simtemp_ring_buff_t *rb, simtemp_sample_t *value);
+/* Move a cursor left behind the tail up to it. Returns the samples it missed */
+static inline unsigned int rb_cursor_sync(const simtemp_ring_buff_t *rb,
+					  unsigned int *cursor)
+{
+	unsigned int missed = rb->tail - *cursor;
+
+	/* Signed distance, valid across wraps of the counters */
+	if ((int)missed <= 0)
+		return 0;
+
+	*cursor = rb->tail;
+	return missed;
+}
+
+/* Samples still kept for a cursor (all of them if it is behind the tail) */
+static inline unsigned int rb_cursor_pending(const simtemp_ring_buff_t *rb,
+					     unsigned int cursor)
+{
+	unsigned int pending = rb->head - cursor;
+
+	return (pending < rb_count(rb)) ? pending : rb_count(rb);
+}
 
-int rb_peek(simtemp_ring_buff_t *rb, simtemp_sample_t *value);
+/* Peek the sample at a (synced) cursor */
+static inline int rb_cursor_peek(const simtemp_ring_buff_t *rb,
+				 unsigned int cursor, simtemp_sample_t *value)
+{
+	if (cursor == rb->head)
+		return 0;
 
-bool rb_is_empty(simtemp_ring_buff_t *rb);
+	*value = rb->readings[rb_index(cursor)];
+	return 1;
+}
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,265 @@
+#include <kunit/test.h>
+#include <linux/limits.h>
+#include <linux/module.h>
+
+#include "ring_buff_helper.h"
+
+/*
+** KUnit tests for the header-only sample ring buffer
+*/
+
+static simtemp_ring_buff_t *rb_alloc(struct kunit *test)
+{
+	simtemp_ring_buff_t *rb;
+
+	rb = kunit_kzalloc(test, sizeof(*rb), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, rb);
+
+	return rb;
+}
+
+/* Sample tagged with its insertion order */
+static simtemp_sample_t rb_sample(unsigned int seq)
+{
+	simtemp_sample_t sample = {
+		.timestamp_ns = seq,
+		.temp_mC = 25000,
+		.flags = SIMTEMP_EVT_NEW,
+		.seq = seq,
+	};
+
+	return sample;
+}
+
+/* Put 'count' samples numbered from 'first' */
+static void rb_fill(struct kunit *test, simtemp_ring_buff_t *rb,
+		    unsigned int first, unsigned int count)
+{
+	simtemp_sample_t sample;
+	unsigned int i;
+
+	for (i = 0; i < count; i++) {
+		sample = rb_sample(first + i);
+		KUNIT_ASSERT_FALSE(test, rb_put(rb, &sample, false));
+	}
+}
+
+/* Read at a cursor the way a reader does: catch up, peek, advance */
+static int rb_read(simtemp_ring_buff_t *rb, unsigned int *cursor,
+		   simtemp_sample_t *value)
+{
+	rb_cursor_sync(rb, cursor);
+	if (!rb_cursor_peek(rb, *cursor, value))
+		return 0;
+
+	(*cursor)++;
+	return 1;
+}
+
+static void rb_test_empty_full(struct kunit *test)
+{
+	simtemp_ring_buff_t *rb = rb_alloc(test);
+	simtemp_sample_t sample;
+	unsigned int cursor = 0;
+	unsigned int i;
+
+	KUNIT_EXPECT_TRUE(test, rb_is_empty(rb));
+	KUNIT_EXPECT_FALSE(test, rb_is_full(rb));
+	KUNIT_EXPECT_EQ(test, rb_count(rb), 0U);
+	KUNIT_EXPECT_EQ(test, rb_cursor_pending(rb, cursor), 0U);
+	KUNIT_EXPECT_EQ(test, rb_read(rb, &cursor, &sample), 0);
+
+	rb_fill(test, rb, 0, TEMP_SAMPLE_BUF_SIZE);
+
+	/* Full and empty never alias (head == tail only when empty) */
+	KUNIT_EXPECT_TRUE(test, rb_is_full(rb));
+	KUNIT_EXPECT_FALSE(test, rb_is_empty(rb));
+	KUNIT_EXPECT_EQ(test, rb_count(rb), (unsigned int)TEMP_SAMPLE_BUF_SIZE);
+	KUNIT_EXPECT_EQ(test, rb_cursor_pending(rb, cursor),
+			(unsigned int)TEMP_SAMPLE_BUF_SIZE);
+
+	for (i = 0; i < TEMP_SAMPLE_BUF_SIZE; i++) {
+		KUNIT_ASSERT_EQ(test, rb_read(rb, &cursor, &sample), 1);
+		KUNIT_EXPECT_EQ(test, sample.seq, i);
+		KUNIT_EXPECT_EQ(test, sample.flags, (u32)SIMTEMP_EVT_NEW);
+	}
+
+	/* Reading never consumes: the tail is moved by the owner */
+	KUNIT_EXPECT_EQ(test, rb_read(rb, &cursor, &sample), 0);
+	KUNIT_EXPECT_EQ(test, rb_cursor_pending(rb, cursor), 0U);
+	KUNIT_EXPECT_TRUE(test, rb_is_full(rb));
+}
+
+static void rb_test_overwrite(struct kunit *test)
+{
+	simtemp_ring_buff_t *rb = rb_alloc(test);
+	simtemp_sample_t sample = rb_sample(TEMP_SAMPLE_BUF_SIZE);
+	unsigned int slow = 0, fast = 1;
+	unsigned int i;
+
+	rb_fill(test, rb, 0, TEMP_SAMPLE_BUF_SIZE);
+
+	/* The oldest sample goes, the incoming one is stored */
+	KUNIT_EXPECT_TRUE(test, rb_put(rb, &sample, true));
+	KUNIT_EXPECT_EQ(test, rb->tail, 1U);
+	KUNIT_EXPECT_EQ(test, rb->head, (unsigned int)TEMP_SAMPLE_BUF_SIZE + 1);
+	KUNIT_EXPECT_TRUE(test, rb_is_full(rb));
+	KUNIT_EXPECT_FALSE(test, rb->gap_pending);
+
+	/* Only the cursor still on the dropped sample missed it */
+	KUNIT_EXPECT_EQ(test, rb_cursor_sync(rb, &slow), 1U);
+	KUNIT_EXPECT_EQ(test, slow, 1U);
+	KUNIT_EXPECT_EQ(test, rb_cursor_sync(rb, &fast), 0U);
+
+	/* No sample in the ring carries a shared gap flag */
+	for (i = 0; i < TEMP_SAMPLE_BUF_SIZE; i++) {
+		KUNIT_ASSERT_EQ(test, rb_read(rb, &fast, &sample), 1);
+		KUNIT_EXPECT_EQ(test, sample.seq, i + 1);
+		KUNIT_EXPECT_FALSE(test, sample.flags & SIMTEMP_EVT_OVERRUN);
+	}
+}
+
+static void rb_test_drop_newest(struct kunit *test)
+{
+	simtemp_ring_buff_t *rb = rb_alloc(test);
+	simtemp_sample_t sample = rb_sample(TEMP_SAMPLE_BUF_SIZE);
+	unsigned int cursor = 0;
+
+	rb_fill(test, rb, 0, TEMP_SAMPLE_BUF_SIZE);
+
+	/* The incoming sample is discarded, the ring is left untouched */
+	KUNIT_EXPECT_TRUE(test, rb_put(rb, &sample, false));
+	KUNIT_EXPECT_TRUE(test, rb->gap_pending);
+	KUNIT_EXPECT_EQ(test, rb->tail, 0U);
+	KUNIT_EXPECT_EQ(test, rb->head, (unsigned int)TEMP_SAMPLE_BUF_SIZE);
+
+	KUNIT_ASSERT_EQ(test, rb_read(rb, &cursor, &sample), 1);
+	KUNIT_EXPECT_EQ(test, sample.seq, 0U);
+	KUNIT_EXPECT_FALSE(test, sample.flags & SIMTEMP_EVT_OVERRUN);
+
+	/* The reader made room: the first sample stored after the gap flags it */
+	rb->tail = cursor;
+	sample = rb_sample(TEMP_SAMPLE_BUF_SIZE + 1);
+	KUNIT_EXPECT_FALSE(test, rb_put(rb, &sample, false));
+	KUNIT_EXPECT_FALSE(test, rb->gap_pending);
+
+	KUNIT_ASSERT_EQ(test, rb_cursor_peek(rb, rb->head - 1, &sample), 1);
+	KUNIT_EXPECT_EQ(test, sample.seq, (u32)TEMP_SAMPLE_BUF_SIZE + 1);
+	KUNIT_EXPECT_TRUE(test, sample.flags & SIMTEMP_EVT_OVERRUN);
+}
+
+static void rb_test_cursor_bounds(struct kunit *test)
+{
+	simtemp_ring_buff_t *rb = rb_alloc(test);
+	simtemp_sample_t sample;
+	unsigned int cursor = 0;
+	unsigned int i;
+
+	KUNIT_EXPECT_EQ(test, rb_cursor_peek(rb, cursor, &sample), 0);
+
+	rb_fill(test, rb, 0, 3);
+
+	for (i = 0; i < 3; i++) {
+		KUNIT_ASSERT_EQ(test, rb_cursor_peek(rb, i, &sample), 1);
+		KUNIT_EXPECT_EQ(test, sample.seq, i);
+	}
+	KUNIT_EXPECT_EQ(test, rb_cursor_peek(rb, 3, &sample), 0);
+
+	/* Pending samples are clipped to what the ring still holds */
+	KUNIT_EXPECT_EQ(test, rb_cursor_pending(rb, 1), 2U);
+	rb_drop_oldest(rb);
+	rb_drop_oldest(rb);
+	KUNIT_EXPECT_EQ(test, rb_cursor_pending(rb, cursor), 1U);
+	KUNIT_EXPECT_EQ(test, rb_cursor_pending(rb, rb->head), 0U);
+
+	/* A cursor ahead of the tail is never moved back */
+	cursor = rb->head;
+	KUNIT_EXPECT_EQ(test, rb_cursor_sync(rb, &cursor), 0U);
+	KUNIT_EXPECT_EQ(test, cursor, rb->head);
+}
+
+static void rb_test_wrap(struct kunit *test)
+{
+	simtemp_ring_buff_t *rb = rb_alloc(test);
+	simtemp_sample_t sample;
+	unsigned int cursor;
+	unsigned int i;
+
+	/* Free running counters about to wrap */
+	rb->head = UINT_MAX - 2;
+	rb->tail = UINT_MAX - 2;
+	cursor = rb->tail;
+
+	rb_fill(test, rb, 0, 6);
+	KUNIT_EXPECT_EQ(test, rb->head, 3U);
+	KUNIT_EXPECT_EQ(test, rb_count(rb), 6U);
+	KUNIT_EXPECT_EQ(test, rb_cursor_pending(rb, cursor), 6U);
+
+	for (i = 0; i < 6; i++) {
+		KUNIT_ASSERT_EQ(test, rb_read(rb, &cursor, &sample), 1);
+		KUNIT_EXPECT_EQ(test, sample.seq, i);
+	}
+	KUNIT_EXPECT_EQ(test, cursor, 3U);
+	KUNIT_EXPECT_EQ(test, rb_read(rb, &cursor, &sample), 0);
+
+	/* Full detection and overwrite across the wrap */
+	rb->head = UINT_MAX - 2;
+	rb->tail = UINT_MAX - 2;
+	cursor = rb->tail;
+	rb_fill(test, rb, 0, TEMP_SAMPLE_BUF_SIZE);
+	KUNIT_EXPECT_TRUE(test, rb_is_full(rb));
+	sample = rb_sample(TEMP_SAMPLE_BUF_SIZE);
+	KUNIT_EXPECT_TRUE(test, rb_put(rb, &sample, true));
+	KUNIT_EXPECT_EQ(test, rb->tail, UINT_MAX - 1);
+	KUNIT_EXPECT_EQ(test, rb_count(rb), (unsigned int)TEMP_SAMPLE_BUF_SIZE);
+	KUNIT_EXPECT_EQ(test, rb_cursor_sync(rb, &cursor), 1U);
+}
+
+static void rb_test_cursor(struct kunit *test)
+{
+	simtemp_ring_buff_t *rb = rb_alloc(test);
+	simtemp_sample_t sample;
+	unsigned int slow, fast;
+
+	rb->head = UINT_MAX - 2;
+	rb->tail = UINT_MAX - 2;
+	slow = rb->tail;
+
+	rb_fill(test, rb, 0, TEMP_SAMPLE_BUF_SIZE);
+	fast = rb->tail + 2;
+
+	/* Overwriting moves the tail past the slow cursor only */
+	rb_drop_oldest(rb);
+	rb_drop_oldest(rb);
+	KUNIT_EXPECT_EQ(test, rb_cursor_sync(rb, &slow), 2U);
+	KUNIT_EXPECT_EQ(test, slow, rb->tail);
+	KUNIT_EXPECT_EQ(test, rb_cursor_sync(rb, &fast), 0U);
+	KUNIT_EXPECT_EQ(test, rb_cursor_sync(rb, &slow), 0U);
+
+	KUNIT_ASSERT_EQ(test, rb_cursor_peek(rb, slow, &sample), 1);
+	KUNIT_EXPECT_EQ(test, sample.seq, 2U);
+	KUNIT_EXPECT_FALSE(test, sample.flags & SIMTEMP_EVT_OVERRUN);
+
+	/* A cursor at the head has nothing pending */
+	KUNIT_EXPECT_EQ(test, rb_cursor_peek(rb, rb->head, &sample), 0);
+}
+
+static struct kunit_case rb_test_cases[] = {
+	KUNIT_CASE(rb_test_empty_full),
+	KUNIT_CASE(rb_test_overwrite),
+	KUNIT_CASE(rb_test_drop_newest),
+	KUNIT_CASE(rb_test_cursor_bounds),
+	KUNIT_CASE(rb_test_wrap),
+	KUNIT_CASE(rb_test_cursor),
+	{}
+};
+
+static struct kunit_suite rb_test_suite = {
+	.name = "simtemp-ring-buffer",
+	.test_cases = rb_test_cases,
+};
+
+kunit_test_suite(rb_test_suite);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("KUnit tests for the simtemp sample ring buffer");
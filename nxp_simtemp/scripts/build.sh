@@ -40,13 +40,30 @@ main() {
         exit "${ERR_EXEC_MAKE}"
     fi
 
-    # Creating the virtual environment for the GUI
     USR_DRV_DIR="${ROOT_PROJ_DIR}/user"
     if [[ ! -d "${USR_DRV_DIR}" ]]; then
         echo -e "${BRED}ERROR:${COLOR_OFF} The user-space directory is not present at ${USR_DRV_DIR}"
         exit "${ERR_NOT_A_DIR}"
     fi
 
+    # Building the native consumer library (used by the CLI/GUI backend)
+    echo -e "${BWHITE}INFO:${COLOR_OFF} Building libsimtemp ..."
+    make -C "${USR_DRV_DIR}/lib" all
+    if [ "$?" -ne "0" ]; then
+        echo -e "${BRED}ERROR:${COLOR_OFF} libsimtemp build failed!"
+        exit "${ERR_EXEC_MAKE}"
+    fi
+
+    # Building the native benchmark
+    echo -e "${BWHITE}INFO:${COLOR_OFF} Building the benchmark ..."
+    make -C "${USR_DRV_DIR}/bench" all
+    if [ "$?" -ne "0" ]; then
+        echo -e "${BRED}ERROR:${COLOR_OFF} Benchmark build failed!"
+        exit "${ERR_EXEC_MAKE}"
+    fi
+
+    # Creating the virtual environment for the GUI
+
     cd "${USR_DRV_DIR}"
     if [[ ! -d "${USR_DRV_DIR}/.venv" ]]; then
         echo -e "${BWHITE}INFO:${COLOR_OFF} Creating the virtual environment for the GUI ..."
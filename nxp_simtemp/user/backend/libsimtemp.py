@@ -0,0 +1,161 @@
+"""ctypes binding for libsimtemp (native batched consumer library)"""
+import os
+import ctypes
+from typing import Optional, Sequence
+
+# Default location: user/lib/libsimtemp.so (override with SIMTEMP_LIB)
+_DEFAULT_LIB = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'lib', 'libsimtemp.so')
+
+SIMTEMP_WAIT_DATA = 0
+SIMTEMP_WAIT_ALERT = 1
+
+
+class SimTempFilter(ctypes.Structure):
+    """Mirror of struct simtemp_filter"""
+    _fields_ = [('type', ctypes.c_uint32),
+                ('low_mC', ctypes.c_int32),
+                ('high_mC', ctypes.c_int32),
+                ('delta_mC', ctypes.c_uint32),
+                ('decimation', ctypes.c_uint32),
+                ('flags_mask', ctypes.c_uint32)]
+
+
+class SimTempStats(ctypes.Structure):
+    """Mirror of struct simtemp_stats"""
+    _fields_ = [('updates', ctypes.c_uint64),
+                ('alerts', ctypes.c_uint64),
+                ('overruns', ctypes.c_uint64),
+                ('reads', ctypes.c_uint64),
+                ('bytes', ctypes.c_uint64),
+                ('polls', ctypes.c_uint64),
+                ('wakeups', ctypes.c_uint64),
+                ('readers', ctypes.c_uint32),
+                ('reserved', ctypes.c_uint32)]
+
+
+def _load() -> Optional[ctypes.CDLL]:
+    """Load the shared library, None if it was not built"""
+    path = os.environ.get('SIMTEMP_LIB', _DEFAULT_LIB)
+    try:
+        lib = ctypes.CDLL(path, use_errno=True)
+    except OSError:
+        return None
+
+    ctx = ctypes.c_void_p
+    u32_p = ctypes.POINTER(ctypes.c_uint32)
+    lib.simtemp_open.argtypes = [ctypes.POINTER(ctypes.c_char_p), ctypes.c_uint]
+    lib.simtemp_open.restype = ctx
+    lib.simtemp_close.argtypes = [ctx]
+    lib.simtemp_close.restype = None
+    lib.simtemp_epoll_fd.argtypes = [ctx]
+    lib.simtemp_wait.argtypes = [ctx, ctypes.c_int, ctypes.c_int]
+    lib.simtemp_read_batch.argtypes = [ctx, ctypes.c_size_t, u32_p,
+                                       ctypes.POINTER(ctypes.c_uint64),
+                                       ctypes.POINTER(ctypes.c_int32), u32_p, u32_p, u32_p]
+    lib.simtemp_read_raw.argtypes = [ctx, ctypes.c_size_t, u32_p, ctypes.c_void_p]
+    lib.simtemp_set_filter.argtypes = [ctx, ctypes.c_uint, ctypes.POINTER(SimTempFilter)]
+    lib.simtemp_get_stats.argtypes = [ctx, ctypes.c_uint, ctypes.POINTER(SimTempStats)]
+    lib.simtemp_get_attr.argtypes = [ctx, ctypes.c_uint, ctypes.c_char_p,
+                                     ctypes.c_char_p, ctypes.c_size_t]
+    lib.simtemp_set_attr.argtypes = [ctx, ctypes.c_uint, ctypes.c_char_p, ctypes.c_char_p]
+    return lib
+
+
+_lib = _load()
+
+
+def available() -> bool:
+    return _lib is not None
+
+
+class SampleBatch:
+    """Decoded samples in parallel arrays (filled in place by the library)"""
+
+    def __init__(self, capacity: int):
+        self.capacity = capacity
+        self.count = 0
+        self.sensor = (ctypes.c_uint32 * capacity)()
+        self.timestamp_ns = (ctypes.c_uint64 * capacity)()
+        self.temp_mc = (ctypes.c_int32 * capacity)()
+        self.flags = (ctypes.c_uint32 * capacity)()
+        self.seq = (ctypes.c_uint32 * capacity)()
+        self.channel = (ctypes.c_uint32 * capacity)()
+
+
+class LibSimTemp:
+    """One epoll-multiplexed context over several sensors"""
+
+    def __init__(self, names: Sequence[str]):
+        if _lib is None:
+            raise OSError("libsimtemp.so not found (build user/lib first)")
+        arr = (ctypes.c_char_p * len(names))(*[n.encode() for n in names])
+        self._ctx = _lib.simtemp_open(arr, len(names))
+        if not self._ctx:
+            err = ctypes.get_errno()
+            raise OSError(err, os.strerror(err))
+
+    def close(self):
+        if self._ctx:
+            _lib.simtemp_close(self._ctx)
+            self._ctx = None
+
+    def fileno(self) -> int:
+        return _lib.simtemp_epoll_fd(self._ctx)
+
+    def wait(self, timeout_ms: int = -1, alert: bool = False) -> int:
+        """Number of ready sensors (0 on timeout)"""
+        ret = _lib.simtemp_wait(self._ctx, timeout_ms,
+                                SIMTEMP_WAIT_ALERT if alert else SIMTEMP_WAIT_DATA)
+        if ret < 0:
+            raise OSError(-ret, os.strerror(-ret))
+        return ret
+
+    def read_batch(self, batch: SampleBatch, max_samples: Optional[int] = None) -> int:
+        """Fill 'batch' with pending samples; returns (and stores) the count"""
+        n = batch.capacity if max_samples is None else min(max_samples, batch.capacity)
+        ret = _lib.simtemp_read_batch(self._ctx, n, batch.sensor, batch.timestamp_ns,
+                                      batch.temp_mc, batch.flags, batch.seq, batch.channel)
+        if ret < 0:
+            raise OSError(-ret, os.strerror(-ret))
+        batch.count = ret
+        return ret
+
+    def read_batch_into(self, max_samples: int, sensor, timestamp_ns, temp_mc, flags,
+                        seq=None, channel=None) -> int:
+        """Decode straight into caller-owned buffers (ctypes pointers, None to skip)"""
+        ret = _lib.simtemp_read_batch(self._ctx, max_samples, sensor, timestamp_ns, temp_mc, flags,
+                                      seq, channel)
+        if ret < 0:
+            raise OSError(-ret, os.strerror(-ret))
+        return ret
+
+    def read_raw(self, buf_addr: int, max_samples: int, sensor=None) -> int:
+        """memcpy up to max_samples raw 24-byte records to buf_addr (e.g. a numpy array)"""
+        ret = _lib.simtemp_read_raw(self._ctx, max_samples, sensor, buf_addr)
+        if ret < 0:
+            raise OSError(-ret, os.strerror(-ret))
+        return ret
+
+    def set_filter(self, sensor: int, flt: SimTempFilter):
+        ret = _lib.simtemp_set_filter(self._ctx, sensor, ctypes.byref(flt))
+        if ret < 0:
+            raise OSError(-ret, os.strerror(-ret))
+
+    def get_stats(self, sensor: int) -> SimTempStats:
+        stats = SimTempStats()
+        ret = _lib.simtemp_get_stats(self._ctx, sensor, ctypes.byref(stats))
+        if ret < 0:
+            raise OSError(-ret, os.strerror(-ret))
+        return stats
+
+    def get_attr(self, sensor: int, attr: str) -> str:
+        buf = ctypes.create_string_buffer(4096)
+        ret = _lib.simtemp_get_attr(self._ctx, sensor, attr.encode(), buf, len(buf))
+        if ret < 0:
+            raise OSError(-ret, os.strerror(-ret))
+        return buf.value.decode()
+
+    def set_attr(self, sensor: int, attr: str, value) -> None:
+        ret = _lib.simtemp_set_attr(self._ctx, sensor, attr.encode(), str(value).encode())
+        if ret < 0:
+            raise OSError(-ret, os.strerror(-ret))
@@ -3,25 +3,62 @@ import sys
 import os
 import struct
 import select
+import fcntl
+import threading
 from datetime import datetime, timezone
 from dataclasses import dataclass
 from typing import Optional, Callable
 
-# Size of the data structure read from the character device (8 byte timestamp + 4 byte temp + 4 byte flags = 16 bytes)
-SAMPLE_SIZE = 16
-# Struct format: < (little-endian), Q (uint64_t timestamp_ns), i (int32_t temp_mC), I (uint32_t flags)
-STRUCT_FORMAT = '<QiI'
+try:
+    import numpy as np
+except ImportError:  # batch API needs numpy, per-sample API does not
+    np = None
+
+from . import libsimtemp
+
+# Size of the data structure read from the character device (8 byte timestamp + 4 byte temp + 4 byte flags + 4 byte seq + 4 byte channel = 24 bytes)
+SAMPLE_SIZE = 24
+# Struct format: < (little-endian), Q (uint64_t timestamp_ns), i (int32_t temp_mC), I (uint32_t flags), I (uint32_t seq), I (uint32_t channel)
+STRUCT_FORMAT = '<QiIII'
+# Structured dtype matching struct simtemp_sample (for batch decoding)
+SAMPLE_DTYPE = np.dtype([('timestamp_ns', '<u8'), ('temp_mC', '<i4'), ('flags', '<u4'),
+                         ('seq', '<u4'), ('channel', '<u4')]) if np else None
 # Event flags inside the sample data
 SIMTEMP_EVT_NEW = 0x0001
 SIMTEMP_EVT_THRS = 0x0002
+SIMTEMP_EVT_OVERRUN = 0x0004
+
+# Per-fd filter types (struct simtemp_filter: type, low_mC, high_mC, delta_mC, decimation, flags_mask)
+SIMTEMP_FILTER_NONE = 0
+SIMTEMP_FILTER_BAND = 1
+SIMTEMP_FILTER_DELTA = 2
+SIMTEMP_FILTER_DECIMATE = 3
+SIMTEMP_FILTER_FLAGS = 4
+FILTER_FORMAT = '<IiiIII'
+
+def _iow(magic, nr, size):
+    """Linux _IOW() ioctl request number"""
+    return (1 << 30) | (size << 16) | (ord(magic) << 8) | nr
+
+SIMTEMP_IOC_SET_FILTER = _iow('s', 1, struct.calcsize(FILTER_FORMAT))
+
+# Device statistics (statistics/<name> in sysfs, struct simtemp_stats for the ioctl)
+STATS_FIELDS = ('updates', 'alerts', 'overruns', 'reads', 'bytes', 'polls', 'wakeups', 'readers')
 
 @dataclass
 class SensorReading:
     """Temperature reading with metadata"""
-    timestamp: str
+    timestamp_ns: int
     temp_c: float
     is_alert: bool
-    
+    channel: int = 0  # channel of a multi-channel device
+    seq: int = 0  # frame sequence number (shared by the channels of a frame)
+
+    @property
+    def timestamp(self) -> str:
+        """ISO 8601 timestamp (formatted on demand only)"""
+        return format_timestamp(self.timestamp_ns)
+
     def __str__(self):
         return f"{self.timestamp} temp={self.temp_c:.1f}C alert={int(self.is_alert)}"
 
@@ -52,15 +89,52 @@ def format_timestamp(ts_ns):
 class SimTempSensorInterface:
     """Backend interface to temperature sensor driver"""
     
+    # Samples decoded per native batch
+    BATCH_SIZE = 256
+
     def __init__(self, sysfs_path="/sys/class/simtemp/simtemp",
-                 dev_path="/dev/simtemp"):
+                 dev_path="/dev/simtemp", use_lib=True):
         self.sysfs_path = sysfs_path
         self.dev_path = dev_path
         self._fd = None
         self._poller = None
-    
+        # Native path (libsimtemp, once the device is open): cached sysfs fds,
+        # epoll and batched decode
+        self._use_lib = use_lib and libsimtemp.available()
+        self._lib = None
+        self._batch = None
+        self._batch_pos = 0
+        # Config calls may come from another thread than the data path
+        self._lib_lock = threading.Lock()
+
+    def _native(self) -> Optional[libsimtemp.LibSimTemp]:
+        """Native context of the open device (None before open_device() or if unavailable)"""
+        return self._lib
+
+    def _open_native(self) -> bool:
+        """Open the device through libsimtemp (it becomes a reader of the device)"""
+        try:
+            self._lib = libsimtemp.LibSimTemp([os.path.basename(self.dev_path)])
+            self._batch = libsimtemp.SampleBatch(self.BATCH_SIZE)
+            self._batch_pos = 0
+            return True
+        except OSError as e:
+            print(f" libsimtemp unavailable ({e}), using the Python path", file=sys.stderr)
+            self._use_lib = False
+            return False
+
     def write_sysfs(self, attr: str, value) -> bool:
         """Write to sysfs attribute"""
+        with self._lib_lock:
+            lib = self._native()
+            if lib is not None:
+                try:
+                    lib.set_attr(0, attr, value)
+                    return True
+                except OSError as e:
+                    print(f" Failed to write to {attr}: {e}", file=sys.stderr)
+                    return False
+
         path = os.path.join(self.sysfs_path, attr)
         try:
             with open(path, 'w') as f:
@@ -75,6 +149,15 @@ class SimTempSensorInterface:
     
     def read_sysfs(self, attr: str) -> Optional[str]:
         """Read from sysfs attribute"""
+        with self._lib_lock:
+            lib = self._native()
+            if lib is not None:
+                try:
+                    return lib.get_attr(0, attr)
+                except OSError as e:
+                    print(f" Failed to read {attr}: {e}", file=sys.stderr)
+                    return None
+
         path = os.path.join(self.sysfs_path, attr)
         try:
             with open(path, 'r') as f:
@@ -93,6 +176,60 @@ class SimTempSensorInterface:
     def set_sampling_ms(self, value: int) -> bool:
         return self.write_sysfs("sampling_ms", value)
     
+    def get_overflow_policy(self) -> str:
+        return self.read_sysfs("overflow_policy") or "overwrite"
+
+    def set_overflow_policy(self, policy: str) -> bool:
+        return self.write_sysfs("overflow_policy", policy)
+
+    def get_adaptive(self) -> bool:
+        return self.read_sysfs("adaptive") == "1"
+
+    def set_adaptive(self, enable: bool) -> bool:
+        return self.write_sysfs("adaptive", int(enable))
+
+    def get_burst(self) -> tuple:
+        """(pattern, samples per burst)"""
+        val = self.read_sysfs("burst_count")
+        return (self.read_sysfs("burst_pattern") or "off", int(val) if val else 1)
+
+    def set_burst(self, pattern: str, count: int = 1) -> bool:
+        """Generate 'count' samples per tick ('off', 'steady', 'spikes' or 'poisson')"""
+        return self.write_sysfs("burst_count", count) and self.write_sysfs("burst_pattern", pattern)
+
+    def get_channels(self) -> int:
+        val = self.read_sysfs("channels")
+        return int(val) if val else 1
+
+    def get_thresholds_c(self) -> list:
+        """Per-channel thresholds"""
+        val = self.read_sysfs("thresholds_mc")
+        return [int(v) / 1000 for v in val.split()] if val else [self.get_threshold_c()]
+
+    def set_thresholds_c(self, values) -> bool:
+        """Thresholds from channel 0 on (channels not listed keep theirs)"""
+        return self.write_sysfs("thresholds_mc", " ".join(str(int(v * 1000)) for v in values))
+
+    def get_effective_sampling_ms(self) -> int:
+        val = self.read_sysfs("effective_sampling_ms")
+        return int(val) if val else self.get_sampling_ms()
+
+    def get_stats(self) -> dict:
+        """Device counters (one ioctl with the native library, else statistics/ files)"""
+        with self._lib_lock:
+            lib = self._native()
+            if lib is not None:
+                try:
+                    stats = lib.get_stats(0)
+                    return {name: getattr(stats, name) for name in STATS_FIELDS}
+                except OSError:
+                    pass
+        stats = {}
+        for name in STATS_FIELDS:
+            val = self.read_sysfs(f"statistics/{name}")
+            stats[name] = int(val) if val else 0
+        return stats
+
     def get_threshold_c(self) -> float:
         val = self.read_sysfs("threshold_mc")
         return float(val) / 1000 if val else 25.0
@@ -108,6 +245,9 @@ class SimTempSensorInterface:
     
     def open_device(self) -> bool:
         """Open device for polling"""
+        with self._lib_lock:
+            if self._lib is not None or (self._use_lib and self._open_native()):
+                return True
         try:
             self._fd = os.open(self.dev_path, os.O_RDONLY | os.O_NONBLOCK)
             self._poller = select.poll()
@@ -122,13 +262,57 @@ class SimTempSensorInterface:
     
     def close_device(self):
         """Close device"""
+        with self._lib_lock:
+            if self._lib is not None:
+                self._lib.close()
+                self._lib = None
         if self._fd is not None:
             os.close(self._fd)
             self._fd = None
             self._poller = None
     
+    def set_filter(self, ftype: int = SIMTEMP_FILTER_NONE, low_mc: int = 0, high_mc: int = 0,
+                   delta_mc: int = 0, decimation: int = 1, flags_mask: int = 0) -> bool:
+        """Install a kernel-side filter on the open device (rejected samples are never copied)"""
+        try:
+            with self._lib_lock:
+                lib = self._native()
+                if lib is not None:
+                    lib.set_filter(0, libsimtemp.SimTempFilter(ftype, low_mc, high_mc, delta_mc,
+                                                               decimation, flags_mask))
+                    return True
+            if self._fd is None:
+                return False
+            arg = struct.pack(FILTER_FORMAT, ftype, low_mc, high_mc, delta_mc, decimation, flags_mask)
+            fcntl.ioctl(self._fd, SIMTEMP_IOC_SET_FILTER, arg)
+            return True
+        except OSError as e:
+            print(f" Failed to set filter: {e}", file=sys.stderr)
+            return False
+
+    def _read_sample_native(self) -> Optional[SensorReading]:
+        """Next sample from the current native batch (refilled when empty)"""
+        batch = self._batch
+        if self._batch_pos >= batch.count:
+            self._batch_pos = 0
+            if self._lib.read_batch(batch) == 0:
+                return None
+
+        i = self._batch_pos
+        self._batch_pos += 1
+        return SensorReading(batch.timestamp_ns[i],
+                             batch.temp_mc[i] / 1000.0,
+                             bool(batch.flags[i] & SIMTEMP_EVT_THRS),
+                             batch.channel[i], batch.seq[i])
+
     def read_sample(self) -> Optional[SensorReading]:
         """Process a reading (temperature sample)"""
+        if self._lib is not None:
+            try:
+                return self._read_sample_native()
+            except OSError as e:
+                print(f" Read failed: {e}", file=sys.stderr)
+                return None
         try:
             data = os.read(self._fd, SAMPLE_SIZE)
 
@@ -138,13 +322,12 @@ class SimTempSensorInterface:
                 print(f" Short read detected ({len(data)}/{SAMPLE_SIZE} bytes). Skipping sample.", file=sys.stderr)
                 return None
 
-            # Unpack the binary data tuple (timestamp, temperature, flags)
-            ts_ns, temp_mc, flags = struct.unpack(STRUCT_FORMAT, data)
+            # Unpack the binary data tuple (timestamp, temperature, flags, seq, channel)
+            ts_ns, temp_mc, flags, seq, channel = struct.unpack(STRUCT_FORMAT, data)
             temperature = temp_mc / 1000.0
             is_alert = bool(flags & SIMTEMP_EVT_THRS)
-            
-            timestamp = format_timestamp(ts_ns)
-            return SensorReading(timestamp, temperature, is_alert)
+
+            return SensorReading(ts_ns, temperature, is_alert, channel, seq)
 
         except BlockingIOError:
             return None
@@ -154,6 +337,13 @@ class SimTempSensorInterface:
 
     def poll_reading(self, timeout_ms: int = -1, alert = False) -> Optional[SensorReading]:
         """Poll for a single reading (blocking or with timeout)"""
+        if self._lib is not None:
+            if self._batch_pos < self._batch.count:
+                return self.read_sample()
+            if self._lib.wait(timeout_ms, alert) == 0:
+                return None
+            return self.read_sample()
+
         if self._poller is None:
             return None
         
@@ -169,3 +359,59 @@ class SimTempSensorInterface:
             else:
                 return self.read_sample()
 
+    def _pending_native(self):
+        """Samples left in the native per-sample batch, as a structured array"""
+        batch, start = self._batch, self._batch_pos
+        n = batch.count - start
+        out = np.empty(n, dtype=SAMPLE_DTYPE)
+        out['timestamp_ns'] = np.ctypeslib.as_array(batch.timestamp_ns)[start:batch.count]
+        out['temp_mC'] = np.ctypeslib.as_array(batch.temp_mc)[start:batch.count]
+        out['flags'] = np.ctypeslib.as_array(batch.flags)[start:batch.count]
+        out['seq'] = np.ctypeslib.as_array(batch.seq)[start:batch.count]
+        out['channel'] = np.ctypeslib.as_array(batch.channel)[start:batch.count]
+        self._batch_pos = batch.count
+        return out
+
+    def read_batch(self, max_samples: int = BATCH_SIZE):
+        """
+        Read every pending sample (up to max_samples) without blocking.
+        Returns a numpy structured array with SAMPLE_DTYPE fields
+        (timestamp_ns, temp_mC, flags, seq, channel); empty when nothing is pending.
+        """
+        if np is None:
+            raise RuntimeError("numpy is required for batch reads")
+
+        if self._lib is not None:
+            if self._batch_pos < self._batch.count:
+                return self._pending_native()
+            out = np.empty(max_samples, dtype=SAMPLE_DTYPE)
+            n = self._lib.read_raw(out.ctypes.data, max_samples)
+            return out[:n]
+
+        chunks = []
+        remaining = max_samples
+        while remaining > 0:
+            try:
+                data = os.read(self._fd, remaining * SAMPLE_SIZE)
+            except BlockingIOError:
+                break
+            if not data:
+                break
+            # The driver returns whole records (several per read)
+            chunks.append(data[:len(data) - len(data) % SAMPLE_SIZE])
+            remaining -= len(data) // SAMPLE_SIZE
+        return np.frombuffer(b''.join(chunks), dtype=SAMPLE_DTYPE)
+
+    def poll_batch(self, timeout_ms: int = -1, max_samples: int = BATCH_SIZE):
+        """Wait for data (or timeout) and return read_batch()"""
+        if self._lib is not None:
+            if self._batch_pos >= self._batch.count and self._lib.wait(timeout_ms) == 0:
+                return np.empty(0, dtype=SAMPLE_DTYPE)
+            return self.read_batch(max_samples)
+
+        if self._poller is None:
+            return np.empty(0, dtype=SAMPLE_DTYPE)
+        self._poller.modify(self._fd, select.POLLIN)
+        if not self._poller.poll(timeout_ms):
+            return np.empty(0, dtype=SAMPLE_DTYPE)
+        return self.read_batch(max_samples)
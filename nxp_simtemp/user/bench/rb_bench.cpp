@@ -0,0 +1,263 @@
+/*
+ * rb_bench - user-space microbenchmark of the driver's ring buffer
+ *
+ * Builds the same header-only ring the driver uses and measures ns per
+ * put/cursor read/peek (with and without overwrite) and the throughput of
+ * one producer feeding several readers, each walking the whole stream with
+ * its own cursor under a mutex, mirroring data_mutex and the per-fd cursors.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ring_buff_helper.h"
+
+namespace
+{
+
+using bench_clock = std::chrono::steady_clock;
+
+/* Keep the optimizer from dropping the measured work */
+volatile int64_t g_sink;
+
+double ns_per_op(bench_clock::time_point start, uint64_t ops)
+{
+	return std::chrono::duration<double, std::nano>(bench_clock::now() -
+							start)
+		       .count() /
+	       double(ops);
+}
+
+simtemp_sample_t make_sample(uint64_t i)
+{
+	simtemp_sample_t s;
+
+	s.timestamp_ns = i;
+	s.temp_mC = int32_t(25000 + (i & 0xff));
+	s.flags = SIMTEMP_EVT_NEW;
+	s.seq = uint32_t(i);
+	s.channel = 0;
+	return s;
+}
+
+/* Oldest sample any cursor still needs becomes the tail (simtemp_update_tail) */
+void update_tail(simtemp_ring_buff_t *rb,
+		 const std::vector<unsigned int> &cursors)
+{
+	unsigned int pending = 0;
+
+	for (unsigned int cursor : cursors)
+		pending = std::max(pending, rb_cursor_pending(rb, cursor));
+	rb->tail = rb->head - pending;
+}
+
+/* Read at a cursor the way the driver does: catch up, peek, advance */
+int cursor_read(simtemp_ring_buff_t *rb, unsigned int *cursor,
+		simtemp_sample_t *out)
+{
+	rb_cursor_sync(rb, cursor);
+	if (!rb_cursor_peek(rb, *cursor, out))
+		return 0;
+
+	(*cursor)++;
+	return 1;
+}
+
+/* put + cursor read pairs on a never-full ring, one reader */
+double bench_put_read(uint64_t iterations)
+{
+	simtemp_ring_buff_t rb = {};
+	std::vector<unsigned int> cursors(1, 0);
+	simtemp_sample_t out = {};
+	int64_t acc = 0;
+
+	auto start = bench_clock::now();
+	for (uint64_t i = 0; i < iterations; i++) {
+		simtemp_sample_t in = make_sample(i);
+
+		rb_put(&rb, &in, false);
+		cursor_read(&rb, &cursors[0], &out);
+		update_tail(&rb, cursors);
+		acc += out.temp_mC;
+	}
+	double ns = ns_per_op(start, iterations);
+
+	g_sink = acc;
+	return ns;
+}
+
+/* put on a full ring (overwrite-oldest or drop-newest path) */
+double bench_put_full(uint64_t iterations, bool overwrite)
+{
+	simtemp_ring_buff_t rb = {};
+	uint64_t lost = 0;
+
+	for (uint64_t i = 0; i < TEMP_SAMPLE_BUF_SIZE; i++) {
+		simtemp_sample_t in = make_sample(i);
+
+		rb_put(&rb, &in, false);
+	}
+
+	auto start = bench_clock::now();
+	for (uint64_t i = 0; i < iterations; i++) {
+		simtemp_sample_t in = make_sample(i);
+
+		lost += rb_put(&rb, &in, overwrite);
+	}
+	double ns = ns_per_op(start, iterations);
+
+	g_sink = int64_t(lost);
+	return ns;
+}
+
+/* rb_cursor_peek() scan over a full ring (poll/filter skip path) */
+double bench_cursor_scan(uint64_t iterations)
+{
+	simtemp_ring_buff_t rb = {};
+	simtemp_sample_t out;
+	int64_t acc = 0;
+
+	for (uint64_t i = 0; i < TEMP_SAMPLE_BUF_SIZE; i++) {
+		simtemp_sample_t in = make_sample(i);
+
+		rb_put(&rb, &in, false);
+	}
+
+	auto start = bench_clock::now();
+	for (uint64_t i = 0; i < iterations; i++) {
+		for (unsigned int pos = rb.tail; rb_cursor_peek(&rb, pos, &out);
+		     pos++)
+			acc += out.temp_mC;
+	}
+	double ns = ns_per_op(start, iterations * TEMP_SAMPLE_BUF_SIZE);
+
+	g_sink = acc;
+	return ns;
+}
+
+struct multi_result {
+	double per_reader; // samples/s the slowest reader received
+	double delivered; // samples/s summed over all readers
+	uint64_t gaps; // samples a reader skipped (must stay 0)
+};
+
+/*
+ * One producer, 'readers' consumers with their own cursors, all serialized
+ * by one mutex like data_mutex. Each reader gets the whole stream: the
+ * producer backs off while the slowest cursor keeps the ring full, as with
+ * the block policy.
+ */
+multi_result bench_multi_reader(unsigned int readers, unsigned int duration_ms)
+{
+	simtemp_ring_buff_t rb = {};
+	std::vector<unsigned int> cursors(readers, 0);
+	std::vector<uint64_t> received(readers, 0);
+	std::mutex lock;
+	std::atomic<bool> stop{ false };
+	std::atomic<uint64_t> gaps{ 0 };
+	std::vector<std::thread> threads;
+
+	for (unsigned int r = 0; r < readers; r++) {
+		threads.emplace_back([&, r] {
+			simtemp_sample_t out;
+			uint32_t expected = 0;
+			uint64_t n = 0;
+
+			while (!stop.load(std::memory_order_relaxed)) {
+				unsigned int got = 0;
+
+				{
+					std::lock_guard<std::mutex> guard(lock);
+
+					/* One read() worth of samples */
+					while (got < 16 &&
+					       cursor_read(&rb, &cursors[r], &out)) {
+						gaps += out.seq - expected;
+						expected = out.seq + 1;
+						got++;
+					}
+					if (got)
+						update_tail(&rb, cursors);
+				}
+				/* Back off when empty, like a sleeping reader */
+				if (!got)
+					std::this_thread::yield();
+				n += got;
+			}
+			received[r] = n;
+		});
+	}
+
+	threads.emplace_back([&] {
+		uint64_t i = 0;
+
+		while (!stop.load(std::memory_order_relaxed)) {
+			bool full;
+
+			{
+				std::lock_guard<std::mutex> guard(lock);
+
+				full = rb_is_full(&rb);
+				if (!full) {
+					simtemp_sample_t in = make_sample(i++);
+
+					rb_put(&rb, &in, false);
+				}
+			}
+			if (full)
+				std::this_thread::yield();
+		}
+	});
+
+	auto start = bench_clock::now();
+	std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+	stop = true;
+	for (auto &t : threads)
+		t.join();
+
+	double secs = std::chrono::duration<double>(bench_clock::now() - start)
+			      .count();
+	uint64_t slowest = UINT64_MAX, total = 0;
+
+	for (uint64_t n : received) {
+		slowest = std::min(slowest, n);
+		total += n;
+	}
+	return { double(slowest) / secs, double(total) / secs, gaps.load() };
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	uint64_t iterations = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) :
+					   20000000ull;
+
+	printf("ring size: %d samples\n", TEMP_SAMPLE_BUF_SIZE);
+	printf("put+read:           %6.2f ns/pair\n",
+	       bench_put_read(iterations));
+	printf("put full overwrite: %6.2f ns/op\n",
+	       bench_put_full(iterations, true));
+	printf("put full drop:      %6.2f ns/op\n",
+	       bench_put_full(iterations, false));
+	printf("cursor scan:        %6.2f ns/sample\n",
+	       bench_cursor_scan(iterations / TEMP_SAMPLE_BUF_SIZE));
+
+	for (unsigned int readers : { 1u, 2u, 4u, 8u }) {
+		multi_result res = bench_multi_reader(readers, 500);
+
+		printf("%u reader(s):        %10.0f samples/s each, "
+		       "%10.0f delivered, %llu gaps\n",
+		       readers, res.per_reader, res.delivered,
+		       (unsigned long long)res.gaps);
+	}
+
+	return 0;
+}
@@ -0,0 +1,525 @@
+/*
+ * simtemp_bench - throughput/latency benchmark for the simtemp data path
+ *
+ * Sweeps sampling period, burst size, readers per device, I/O style and
+ * device count.
+ * For every scenario it reports delivered samples/s, drops, syscalls per
+ * sample and p50/p99/p999 delivery latency (now - timestamp_ns), as CSV or
+ * JSON so results can be compared across driver versions.
+ */
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "nxp_simtemp_uapi.h"
+
+namespace
+{
+
+enum class io_mode { block, poll, nonblock };
+
+const char *io_mode_name(io_mode mode)
+{
+	switch (mode) {
+	case io_mode::block:
+		return "block";
+	case io_mode::poll:
+		return "poll";
+	default:
+		return "nonblock";
+	}
+}
+
+struct options {
+	std::vector<unsigned int> rates_ms{ 100, 10, 1 };
+	std::vector<unsigned int> bursts{ 1 }; // samples per tick
+	std::vector<unsigned int> readers{ 1, 2, 4 };
+	std::vector<io_mode> modes{ io_mode::block, io_mode::poll,
+				    io_mode::nonblock };
+	std::vector<unsigned int> devices{ 1 };
+	unsigned int duration_s = 5;
+	unsigned int batch = 1; // samples requested per read()
+	bool json = false;
+};
+
+struct scenario {
+	unsigned int rate_ms;
+	unsigned int burst;
+	unsigned int readers;
+	io_mode mode;
+	unsigned int devices;
+};
+
+/* Per reader thread results */
+struct reader_result {
+	unsigned int device = 0;
+	uint64_t samples = 0;
+	uint64_t bytes = 0;
+	uint64_t syscalls = 0;
+	uint64_t overruns = 0; // SIMTEMP_EVT_OVERRUN flags seen
+	std::vector<uint32_t> seqs;
+	std::vector<uint64_t> latencies_ns;
+};
+
+struct scenario_result {
+	scenario sc;
+	double elapsed_s = 0;
+	uint64_t samples = 0;
+	uint64_t bytes = 0;
+	uint64_t syscalls = 0;
+	uint64_t drops = 0;
+	uint64_t p50_ns = 0;
+	uint64_t p99_ns = 0;
+	uint64_t p999_ns = 0;
+};
+
+std::atomic<bool> g_stop{ false };
+std::atomic<bool> g_go{ false }; // every reader drained its backlog
+std::atomic<unsigned int> g_ready{ 0 };
+
+/* Only used to interrupt blocking read()/poll() (no SA_RESTART) */
+void wakeup_handler(int) {}
+
+uint64_t realtime_ns()
+{
+	struct timespec ts;
+
+	/* The driver stamps samples with ktime_get_real() */
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return uint64_t(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+std::string dev_path(unsigned int index)
+{
+	return index ? "/dev/simtemp-" + std::to_string(index) : "/dev/simtemp";
+}
+
+std::string sysfs_path(unsigned int index, const char *attr)
+{
+	std::string name = index ? "simtemp-" + std::to_string(index) :
+				   "simtemp";
+	return "/sys/class/simtemp/" + name + "/" + attr;
+}
+
+bool sysfs_write(unsigned int index, const char *attr, unsigned int value)
+{
+	std::ofstream out(sysfs_path(index, attr));
+
+	out << value;
+	return bool(out);
+}
+
+bool sysfs_write(unsigned int index, const char *attr, const std::string &value)
+{
+	std::ofstream out(sysfs_path(index, attr));
+
+	out << value;
+	return bool(out);
+}
+
+bool sysfs_read(unsigned int index, const char *attr, unsigned int &value)
+{
+	std::ifstream in(sysfs_path(index, attr));
+
+	return bool(in >> value);
+}
+
+bool sysfs_read(unsigned int index, const char *attr, std::string &value)
+{
+	std::ifstream in(sysfs_path(index, attr));
+
+	return bool(in >> value);
+}
+
+void reader_loop(const scenario &sc, unsigned int device,
+		 reader_result &result, unsigned int batch)
+{
+	std::vector<simtemp_sample_t> buf(batch);
+	const size_t buf_len = batch * sizeof(simtemp_sample_t);
+	int flags = O_RDONLY;
+
+	if (sc.mode != io_mode::block)
+		flags |= O_NONBLOCK;
+
+	result.device = device;
+
+	int fd = open(dev_path(device).c_str(), flags);
+	if (fd < 0) {
+		fprintf(stderr, "open %s: %s\n", dev_path(device).c_str(),
+			strerror(errno));
+		g_ready++;
+		return;
+	}
+
+	/*
+	 * A new reader starts at the oldest sample kept in the ring (up to a
+	 * full ring of old samples): discard it so only samples generated
+	 * during the scenario are measured.
+	 */
+	fcntl(fd, F_SETFL, O_NONBLOCK);
+	for (;;) {
+		ssize_t len = read(fd, buf.data(), buf_len);
+
+		if (len <= 0 && !(len < 0 && errno == EINTR))
+			break;
+	}
+	fcntl(fd, F_SETFL, flags & O_NONBLOCK);
+
+	g_ready++;
+	while (!g_go.load() && !g_stop.load())
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	while (!g_stop.load(std::memory_order_relaxed)) {
+		if (sc.mode == io_mode::poll) {
+			struct pollfd pfd = { fd, POLLIN, 0 };
+
+			result.syscalls++;
+			if (poll(&pfd, 1, 100) <= 0)
+				continue;
+		}
+
+		result.syscalls++;
+		ssize_t len = read(fd, buf.data(), buf_len);
+		if (len < 0) {
+			if (errno == EAGAIN || errno == EINTR)
+				continue;
+			fprintf(stderr, "read %s: %s\n",
+				dev_path(device).c_str(), strerror(errno));
+			break;
+		}
+
+		uint64_t now = realtime_ns();
+		size_t n = size_t(len) / sizeof(simtemp_sample_t);
+
+		for (size_t i = 0; i < n; i++) {
+			const simtemp_sample_t &s = buf[i];
+
+			result.seqs.push_back(s.seq);
+			result.latencies_ns.push_back(
+				now > s.timestamp_ns ? now - s.timestamp_ns : 0);
+			if (s.flags & SIMTEMP_EVT_OVERRUN)
+				result.overruns++;
+		}
+		result.samples += n;
+		result.bytes += size_t(len);
+	}
+
+	close(fd);
+}
+
+uint64_t percentile(std::vector<uint64_t> &sorted, double p)
+{
+	if (sorted.empty())
+		return 0;
+
+	size_t idx = size_t(p * double(sorted.size() - 1) + 0.5);
+	return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+/*
+ * Samples missing from one reader's stream (every reader gets the whole
+ * device stream): each frame between the first and last sequence number seen
+ * carries one sample per channel.
+ */
+uint64_t seq_gaps(std::vector<uint32_t> &seqs, unsigned int channels)
+{
+	if (seqs.empty())
+		return 0;
+
+	auto range = std::minmax_element(seqs.begin(), seqs.end());
+	uint64_t expected =
+		(uint64_t(*range.second - *range.first) + 1) * channels;
+
+	return expected > seqs.size() ? expected - seqs.size() : 0;
+}
+
+scenario_result run_scenario(const scenario &sc, const options &opt)
+{
+	scenario_result res;
+	std::vector<reader_result> results(sc.readers * sc.devices);
+	std::vector<std::thread> threads;
+
+	res.sc = sc;
+
+	for (unsigned int d = 0; d < sc.devices; d++) {
+		if (!sysfs_write(d, "sampling_ms", sc.rate_ms))
+			fprintf(stderr, "cannot set sampling_ms on %s\n",
+				dev_path(d).c_str());
+		if (!sysfs_write(d, "burst_count", sc.burst) ||
+		    !sysfs_write(d, "burst_pattern",
+				 sc.burst > 1 ? "steady" : "off"))
+			fprintf(stderr, "cannot set burst on %s\n",
+				dev_path(d).c_str());
+	}
+
+	g_stop = false;
+	g_go = false;
+	g_ready = 0;
+
+	for (unsigned int d = 0; d < sc.devices; d++) {
+		for (unsigned int r = 0; r < sc.readers; r++) {
+			reader_result &rr = results[d * sc.readers + r];
+
+			threads.emplace_back(reader_loop, std::cref(sc), d,
+					     std::ref(rr), opt.batch);
+		}
+	}
+
+	/* The scenario clock starts once every backlog is discarded */
+	while (g_ready.load() < threads.size())
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	auto start = std::chrono::steady_clock::now();
+	g_go = true;
+
+	std::this_thread::sleep_for(std::chrono::seconds(opt.duration_s));
+	g_stop = true;
+
+	/* Kick readers sleeping in read()/poll() */
+	for (auto &t : threads)
+		pthread_kill(t.native_handle(), SIGUSR1);
+	for (auto &t : threads)
+		t.join();
+
+	res.elapsed_s = std::chrono::duration<double>(
+				std::chrono::steady_clock::now() - start)
+				.count();
+
+	std::vector<uint64_t> latencies;
+	std::vector<unsigned int> channels(sc.devices, 1);
+
+	for (unsigned int d = 0; d < sc.devices; d++) {
+		sysfs_read(d, "channels", channels[d]);
+		channels[d] = std::max(channels[d], 1u);
+	}
+
+	/* Sequence gaps count every lost sample, overrun flags only runs */
+	uint64_t gaps = 0;
+	for (auto &rr : results) {
+		res.samples += rr.samples;
+		res.bytes += rr.bytes;
+		res.syscalls += rr.syscalls;
+		res.drops += rr.overruns;
+		latencies.insert(latencies.end(), rr.latencies_ns.begin(),
+				 rr.latencies_ns.end());
+		gaps += seq_gaps(rr.seqs, channels[rr.device]);
+	}
+	res.drops = std::max(res.drops, gaps);
+
+	std::sort(latencies.begin(), latencies.end());
+	res.p50_ns = percentile(latencies, 0.50);
+	res.p99_ns = percentile(latencies, 0.99);
+	res.p999_ns = percentile(latencies, 0.999);
+
+	return res;
+}
+
+void print_csv_header()
+{
+	printf("rate_ms,burst,readers,io,devices,elapsed_s,samples,samples_per_s,"
+	       "bytes,drops,syscalls,syscalls_per_sample,p50_us,p99_us,"
+	       "p999_us\n");
+}
+
+void print_csv(const scenario_result &r)
+{
+	printf("%u,%u,%u,%s,%u,%.3f,%llu,%.1f,%llu,%llu,%llu,%.3f,%.1f,%.1f,"
+	       "%.1f\n",
+	       r.sc.rate_ms, r.sc.burst, r.sc.readers, io_mode_name(r.sc.mode),
+	       r.sc.devices, r.elapsed_s, (unsigned long long)r.samples,
+	       r.samples / r.elapsed_s, (unsigned long long)r.bytes,
+	       (unsigned long long)r.drops, (unsigned long long)r.syscalls,
+	       r.samples ? double(r.syscalls) / r.samples : 0.0,
+	       r.p50_ns / 1e3, r.p99_ns / 1e3, r.p999_ns / 1e3);
+	fflush(stdout);
+}
+
+void print_json(const scenario_result &r, bool first)
+{
+	printf("%s\n  {\"rate_ms\": %u, \"burst\": %u, \"readers\": %u, "
+	       "\"io\": \"%s\", "
+	       "\"devices\": %u, \"elapsed_s\": %.3f, \"samples\": %llu, "
+	       "\"samples_per_s\": %.1f, \"bytes\": %llu, \"drops\": %llu, "
+	       "\"syscalls\": %llu, \"syscalls_per_sample\": %.3f, "
+	       "\"p50_us\": %.1f, \"p99_us\": %.1f, \"p999_us\": %.1f}",
+	       first ? "" : ",", r.sc.rate_ms, r.sc.burst, r.sc.readers,
+	       io_mode_name(r.sc.mode), r.sc.devices, r.elapsed_s,
+	       (unsigned long long)r.samples, r.samples / r.elapsed_s,
+	       (unsigned long long)r.bytes, (unsigned long long)r.drops,
+	       (unsigned long long)r.syscalls,
+	       r.samples ? double(r.syscalls) / r.samples : 0.0,
+	       r.p50_ns / 1e3, r.p99_ns / 1e3, r.p999_ns / 1e3);
+	fflush(stdout);
+}
+
+std::vector<unsigned int> parse_uint_list(const char *arg)
+{
+	std::vector<unsigned int> values;
+	std::stringstream ss(arg);
+	std::string item;
+
+	while (std::getline(ss, item, ','))
+		values.push_back(unsigned(std::stoul(item)));
+
+	return values;
+}
+
+std::vector<io_mode> parse_mode_list(const char *arg)
+{
+	std::vector<io_mode> modes;
+	std::stringstream ss(arg);
+	std::string item;
+
+	while (std::getline(ss, item, ',')) {
+		if (item == "block")
+			modes.push_back(io_mode::block);
+		else if (item == "poll")
+			modes.push_back(io_mode::poll);
+		else if (item == "nonblock")
+			modes.push_back(io_mode::nonblock);
+		else
+			throw std::invalid_argument("unknown io mode " + item);
+	}
+
+	return modes;
+}
+
+void usage(const char *prog)
+{
+	fprintf(stderr,
+		"Usage: %s [options]\n"
+		"  --rates LIST     sampling_ms values (default 100,10,1)\n"
+		"  --burst LIST     samples per tick (default 1)\n"
+		"  --readers LIST   readers per device (default 1,2,4)\n"
+		"  --io LIST        block,poll,nonblock (default all)\n"
+		"  --devices LIST   device counts (default 1)\n"
+		"  --duration SEC   seconds per scenario (default 5)\n"
+		"  --batch N        samples requested per read (default 1)\n"
+		"  --json           JSON output (default CSV)\n",
+		prog);
+}
+
+bool parse_args(int argc, char **argv, options &opt)
+{
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		const char *val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+		if (arg == "--json") {
+			opt.json = true;
+			continue;
+		}
+		if (!val)
+			return false;
+
+		if (arg == "--rates")
+			opt.rates_ms = parse_uint_list(val);
+		else if (arg == "--burst")
+			opt.bursts = parse_uint_list(val);
+		else if (arg == "--readers")
+			opt.readers = parse_uint_list(val);
+		else if (arg == "--io")
+			opt.modes = parse_mode_list(val);
+		else if (arg == "--devices")
+			opt.devices = parse_uint_list(val);
+		else if (arg == "--duration")
+			opt.duration_s = unsigned(std::stoul(val));
+		else if (arg == "--batch")
+			opt.batch = std::max(1u, unsigned(std::stoul(val)));
+		else
+			return false;
+		i++;
+	}
+
+	return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	options opt;
+
+	try {
+		if (!parse_args(argc, argv, opt)) {
+			usage(argv[0]);
+			return 22;
+		}
+	} catch (const std::exception &e) {
+		fprintf(stderr, "%s\n", e.what());
+		usage(argv[0]);
+		return 22;
+	}
+
+	struct sigaction sa = {};
+	sa.sa_handler = wakeup_handler;
+	sigaction(SIGUSR1, &sa, nullptr);
+
+	/* Restore each device's sampling period and burst afterwards */
+	unsigned int max_devices =
+		*std::max_element(opt.devices.begin(), opt.devices.end());
+	std::vector<unsigned int> saved_ms(max_devices, 0);
+	std::vector<unsigned int> saved_burst(max_devices, 1);
+	std::vector<std::string> saved_pattern(max_devices, "off");
+	for (unsigned int d = 0; d < max_devices; d++) {
+		if (!sysfs_read(d, "sampling_ms", saved_ms[d])) {
+			fprintf(stderr, "device %s not available\n",
+				dev_path(d).c_str());
+			return 2;
+		}
+		sysfs_read(d, "burst_count", saved_burst[d]);
+		sysfs_read(d, "burst_pattern", saved_pattern[d]);
+	}
+
+	bool first = true;
+	if (opt.json)
+		printf("[");
+	else
+		print_csv_header();
+
+	for (unsigned int devices : opt.devices)
+		for (unsigned int rate_ms : opt.rates_ms)
+			for (unsigned int burst : opt.bursts)
+				for (unsigned int readers : opt.readers)
+					for (io_mode mode : opt.modes) {
+						scenario sc{ rate_ms, burst,
+							     readers, mode,
+							     devices };
+						scenario_result r =
+							run_scenario(sc, opt);
+
+						if (opt.json)
+							print_json(r, first);
+						else
+							print_csv(r);
+						first = false;
+					}
+
+	if (opt.json)
+		printf("\n]\n");
+
+	for (unsigned int d = 0; d < max_devices; d++) {
+		sysfs_write(d, "sampling_ms", saved_ms[d]);
+		sysfs_write(d, "burst_count", saved_burst[d]);
+		sysfs_write(d, "burst_pattern", saved_pattern[d]);
+	}
+
+	return 0;
+}
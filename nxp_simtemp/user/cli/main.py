@@ -4,13 +4,18 @@ import sys
 import argparse
 from backend.simtemp_interface import SimTempSensorInterface
 
+def format_reading(reading, multi_channel):
+    """Tag readings with their channel on multi-channel devices"""
+    return f"{reading} ch={reading.channel}" if multi_channel else str(reading)
+
 def monitor_readings(sensor):
+    multi_channel = sensor.get_channels() > 1
     if not sensor.open_device(): return 1
     try:
         while True:
             reading = sensor.poll_reading()
             if reading:
-                print(reading)
+                print(format_reading(reading, multi_channel))
     except KeyboardInterrupt:
         print("\n--- Monitor stopped by user. ---")
         ret = 0
@@ -22,6 +27,7 @@ def monitor_readings(sensor):
         return ret
 
 def run_test_mode(sensor):
+    multi_channel = sensor.get_channels() > 1
     if not sensor.open_device(): return 1
 
     # First getting all the enqueued data
@@ -29,7 +35,7 @@ def run_test_mode(sensor):
         while True:
             reading = sensor.read_sample()
             if reading:
-                print(reading)
+                print(format_reading(reading, multi_channel))
             else:
                 break
     except Exception as e:
@@ -58,7 +64,7 @@ def run_test_mode(sensor):
     sensor.close_device()
 
     if reading and reading.is_alert:
-        print(f"{reading}\n")
+        print(f"{format_reading(reading, multi_channel)}\n")
         print("✓ Test PASSED")
         return 0
     else:
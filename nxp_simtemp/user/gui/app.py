@@ -4,14 +4,58 @@ import tkinter as tk
 from tkinter import ttk, messagebox
 import threading
 from queue import Queue, Empty
-from datetime import datetime
 
+import numpy as np
 import matplotlib
 matplotlib.use("TkAgg")
 from matplotlib.figure import Figure
 from matplotlib.backends.backend_tkagg import FigureCanvasTkAgg
 
-from backend.simtemp_interface import SimTempSensorInterface
+from backend.simtemp_interface import SimTempSensorInterface, SensorReading, SIMTEMP_EVT_THRS
+
+# Plot window and redraw cap (the monitor thread reads at any rate)
+WINDOW_S = 10.0
+MAX_POINTS = 10000
+REDRAW_MS = 33
+MAX_TEXT_LINES = 200
+
+
+class SampleRing:
+    """Fixed-size ring of (timestamp_ns, temp_c, alert) numpy columns"""
+
+    def __init__(self, capacity):
+        self.capacity = capacity
+        self.ts = np.zeros(capacity, dtype=np.uint64)
+        self.temp = np.zeros(capacity, dtype=np.float64)
+        self.alert = np.zeros(capacity, dtype=bool)
+        self.head = 0   # next write position
+        self.count = 0
+
+    def clear(self):
+        self.head = 0
+        self.count = 0
+
+    def push(self, batch):
+        """Append a SAMPLE_DTYPE batch (only the newest 'capacity' are kept)"""
+        batch = batch[batch['channel'] == 0]  # multi-channel devices: plot channel 0
+        batch = batch[-self.capacity:]
+        n = len(batch)
+        idx = (self.head + np.arange(n)) % self.capacity
+        self.ts[idx] = batch['timestamp_ns']
+        self.temp[idx] = batch['temp_mC'] / 1000.0
+        self.alert[idx] = (batch['flags'] & SIMTEMP_EVT_THRS) != 0
+        self.head = (self.head + n) % self.capacity
+        self.count = min(self.count + n, self.capacity)
+
+    def ordered(self):
+        """Oldest-to-newest views (copies only when wrapped)"""
+        start = (self.head - self.count) % self.capacity
+        if start + self.count <= self.capacity:
+            sl = slice(start, start + self.count)
+            return self.ts[sl], self.temp[sl], self.alert[sl]
+        order = np.r_[start:self.capacity, 0:self.head]
+        return self.ts[order], self.temp[order], self.alert[order]
+
 
 class TempSensorGUI:
     def __init__(self, root):
@@ -20,16 +64,16 @@ class TempSensorGUI:
         self.sensor = SimTempSensorInterface()
         self.monitoring = False
         self.error_queue = Queue()
-        
+        self.data_queue = Queue()   # sample batches from the monitor thread
+
+        # plotting data
+        self.ring = SampleRing(MAX_POINTS)
+        self._threshold = 25.0
+        self._background = None
+
         # build UI and load sensor defaults
         self._create_widgets()
         self._load_current_config()
-
-        # plotting data
-        self.times = []   # elapsed seconds since start
-        self.temps = []
-        self.alerts = []
-        self._start_time = None
         self._init_plot()
     
     def _create_widgets(self):
@@ -75,18 +119,21 @@ class TempSensorGUI:
         self.root.columnconfigure(0, weight=1)
     
     def _load_current_config(self):
+        self._threshold = self.sensor.get_threshold_c()
         self.sampling_var.set(str(self.sensor.get_sampling_ms()))
-        self.threshold_var.set(f"{self.sensor.get_threshold_c():.1f}")
+        self.threshold_var.set(f"{self._threshold:.1f}")
         self.mode_var.set(self.sensor.get_mode())
     
     def _apply_config(self):
         try:
             self.sensor.set_sampling_ms(int(self.sampling_var.get()))
-            self.sensor.set_threshold_c(float(self.threshold_var.get()))
+            self._threshold = float(self.threshold_var.get())
+            self.sensor.set_threshold_c(self._threshold)
             self.sensor.set_mode(self.mode_var.get())
             self.readings_text.insert(tk.END, "✓ Configuration applied\n")
             # update threshold line on plot
-            self._update_plot()
+            self.threshold_line.set_ydata([self._threshold, self._threshold])
+            self._update_plot(force_full=True)
         except ValueError:
             self.readings_text.insert(tk.END, "✗ Invalid configuration\n")
     
@@ -95,13 +142,15 @@ class TempSensorGUI:
         self.start_btn.config(state='disabled')
         self.stop_btn.config(state='normal')
         self.readings_text.delete(1.0, tk.END)
-        
+        self.ring.clear()
+
         # Run monitoring in background thread
         thread = threading.Thread(target=self._monitor_loop, daemon=True)
         thread.start()
-        
-        # Start error checking
+
+        # Start error checking and the capped-rate redraw
         self.root.after(100, self._check_errors)
+        self.root.after(REDRAW_MS, self._drain_and_redraw)
     
     def _stop_monitoring(self):
         self.monitoring = False
@@ -112,52 +161,48 @@ class TempSensorGUI:
         if not self.sensor.open_device():
             self.error_queue.put("Failed to open device. Run the GUI as sudo or check if the kernel module is loaded")
             return
-            
+
         try:
             while self.monitoring:
-                reading = self.sensor.poll_reading()
-                if reading:
-                    # Update GUI from background thread (use after_idle for thread safety)
-                    self.root.after_idle(self._add_reading, reading)
+                # Whole batches, decoded with numpy (short timeout to notice stop)
+                batch = self.sensor.poll_batch(200)
+                if len(batch):
+                    self.data_queue.put(batch)
         except Exception as e:
             self.error_queue.put(f"Monitoring error: {str(e)}")
         finally:
             self.sensor.close_device()
-    
-    def _add_reading(self, text):
-        # `text` is a SensorReading object; show text and update plot
+
+    def _drain_and_redraw(self):
+        """Main thread: fold queued batches into the ring and redraw once"""
+        last = None
         try:
-            reading = text
-            self.readings_text.insert(tk.END, str(reading) + "\n")
-            self.readings_text.see(tk.END)
-
-            # parse timestamp (ISO 8601 with trailing Z)
-            try:
-                dt = datetime.fromisoformat(reading.timestamp.replace('Z', '+00:00'))
-            except Exception:
-                dt = datetime.utcnow()
-
-            if self._start_time is None:
-                self._start_time = dt
-
-            elapsed = (dt - self._start_time).total_seconds()
-            self.times.append(elapsed)
-            self.temps.append(reading.temp_c)
-            self.alerts.append(bool(reading.is_alert))
-
-            # keep recent samples only
-            MAX_POINTS = 200
-            if len(self.times) > MAX_POINTS:
-                self.times = self.times[-MAX_POINTS:]
-                self.temps = self.temps[-MAX_POINTS:]
-                self.alerts = self.alerts[-MAX_POINTS:]
+            while True:
+                last = self.data_queue.get_nowait()
+                self.ring.push(last)
+        except Empty:
+            pass
 
+        if last is not None:
+            frame = last[last['channel'] == 0]  # same channel as the plot
+            if len(frame):
+                self._add_reading(frame[-1])
             self._update_plot()
-        except Exception as e:
-            # fallback: just display raw
-            self.readings_text.insert(tk.END, str(text) + "\n")
-            self.readings_text.see(tk.END)
-        
+
+        if self.monitoring:
+            self.root.after(REDRAW_MS, self._drain_and_redraw)
+
+    def _add_reading(self, sample):
+        """Show the newest sample of the frame (text is not per-sample)"""
+        reading = SensorReading(int(sample['timestamp_ns']), sample['temp_mC'] / 1000.0,
+                                bool(sample['flags'] & SIMTEMP_EVT_THRS),
+                                int(sample['channel']), int(sample['seq']))
+        self.readings_text.insert(tk.END, str(reading) + "\n")
+        lines = int(self.readings_text.index('end-1c').split('.')[0])
+        if lines > MAX_TEXT_LINES:
+            self.readings_text.delete(1.0, f"{lines - MAX_TEXT_LINES}.0")
+        self.readings_text.see(tk.END)
+
     def _check_errors(self):
         """Check for errors from the background thread"""
         try:
@@ -173,59 +218,64 @@ class TempSensorGUI:
 
     # --- plotting helpers -------------------------------------------------
     def _init_plot(self):
-        """Create matplotlib Figure and initial empty plot embedded in Tk."""
+        """Create the figure once; samples update artists in place (blitting)."""
         self.fig = Figure(figsize=(6, 3))
         self.ax = self.fig.add_subplot(111)
         self.ax.set_title('Temperature')
-        self.ax.set_xlabel('Time (s)')
+        self.ax.set_xlabel('Time (s, relative to newest sample)')
         self.ax.set_ylabel('Temperature (°C)')
         self.ax.grid(True)
+        self.ax.set_xlim(-WINDOW_S, 0)
+        self.ax.set_ylim(self._threshold - 5, self._threshold + 5)
 
-        # initial empty plot
-        self.ax.plot([], [], '-o', color='tab:blue')
-        # threshold line placeholder
-        thresh = self.sensor.get_threshold_c()
-        self.threshold_line = self.ax.axhline(thresh, color='orange', linestyle='--', label='threshold')
+        # animated artists are only drawn by _blit()
+        self.line, = self.ax.plot([], [], '-', color='tab:blue', label='temp', animated=True)
+        self.alert_pts = self.ax.scatter([], [], color='red', zorder=5, label='alert', animated=True)
+        self.threshold_line = self.ax.axhline(self._threshold, color='orange', linestyle='--',
+                                              label='threshold', animated=True)
+        self.ax.legend(loc='upper right')
+        self.fig.tight_layout()
 
         self.canvas = FigureCanvasTkAgg(self.fig, master=self.plot_frame)
-        self.canvas.draw()
+        self.canvas.mpl_connect('draw_event', self._on_draw)
         self.canvas.get_tk_widget().pack(fill='both', expand=True)
+        self.canvas.draw()
 
-    def _update_plot(self):
-        """Redraw the plot from current data (safe to call from main thread)."""
-        if not hasattr(self, 'ax'):
-            return
+    def _on_draw(self, event):
+        """Full redraw (resize, axis change): grab the static background"""
+        self._background = self.canvas.copy_from_bbox(self.fig.bbox)
+        self._draw_artists()
 
-        # copy lists to avoid mutation during draw
-        xs = list(self.times)
-        ys = list(self.temps)
-        alerts = list(self.alerts)
+    def _draw_artists(self):
+        for artist in (self.threshold_line, self.line, self.alert_pts):
+            self.ax.draw_artist(artist)
 
-        self.ax.clear()
-        self.ax.grid(True)
-        self.ax.set_title('Temperature')
-        self.ax.set_xlabel('Time (s)')
-        self.ax.set_ylabel('Temperature (°C)')
+    def _update_plot(self, force_full=False):
+        """Update artists from the ring; full redraw only if the y range must grow."""
+        if not hasattr(self, 'ax'):
+            return
 
-        if xs and ys:
-            self.ax.plot(xs, ys, '-o', color='tab:blue', markersize=5, label='temp')
+        ts, temps, alerts = self.ring.ordered()
+        if len(ts):
+            xs = (ts.astype(np.int64) - np.int64(ts[-1])) / 1e9
+            self.line.set_data(xs, temps)
+            self.alert_pts.set_offsets(np.column_stack((xs[alerts], temps[alerts])))
 
-            # highlight alert points in red
-            alert_x = [x for x, a in zip(xs, alerts) if a]
-            alert_y = [y for y, a in zip(ys, alerts) if a]
-            if alert_x:
-                self.ax.scatter(alert_x, alert_y, color='red', zorder=5, label='alert')
+            lo = min(temps.min(), self._threshold)
+            hi = max(temps.max(), self._threshold)
+            ymin, ymax = self.ax.get_ylim()
+            if lo < ymin or hi > ymax:
+                margin = max(1.0, 0.1 * (hi - lo))
+                self.ax.set_ylim(lo - margin, hi + margin)
+                force_full = True
 
-        # threshold
-        try:
-            thresh = float(self.sensor.get_threshold_c())
-            self.ax.axhline(thresh, color='orange', linestyle='--', label='threshold')
-        except Exception:
-            pass
+        if force_full or self._background is None:
+            self.canvas.draw()   # _on_draw re-captures background and artists
+            return
 
-        self.ax.legend(loc='upper right')
-        self.fig.tight_layout()
-        self.canvas.draw()
+        self.canvas.restore_region(self._background)
+        self._draw_artists()
+        self.canvas.blit(self.fig.bbox)
 
 def main():
     root = tk.Tk()
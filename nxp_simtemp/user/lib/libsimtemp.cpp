@@ -0,0 +1,380 @@
+/*
+ * libsimtemp - native consumer library for simtemp sensors
+ */
+#include "libsimtemp.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace
+{
+
+/* Samples pulled from the driver per read() (matches SIMTEMP_READ_BATCH) */
+constexpr size_t read_batch = 16;
+
+class sensor {
+    public:
+	explicit sensor(const std::string &name) : name_(name)
+	{
+	}
+
+	~sensor()
+	{
+		for (auto &entry : attrs_)
+			close(entry.second);
+		if (fd_ >= 0)
+			close(fd_);
+	}
+
+	sensor(const sensor &) = delete;
+	sensor &operator=(const sensor &) = delete;
+
+	int open_dev()
+	{
+		fd_ = open(("/dev/" + name_).c_str(),
+			   O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+		return fd_ < 0 ? -errno : 0;
+	}
+
+	int fd() const
+	{
+		return fd_;
+	}
+
+	/* Attribute fd, opened once and reused with pread()/pwrite() */
+	int attr_fd(const char *attr)
+	{
+		auto it = attrs_.find(attr);
+		if (it != attrs_.end())
+			return it->second;
+
+		std::string path = "/sys/class/simtemp/" + name_ + "/" + attr;
+		int fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+		if (fd < 0 && (errno == EACCES || errno == EPERM))
+			fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+			return -errno;
+
+		attrs_.emplace(attr, fd);
+		return fd;
+	}
+
+	bool ready = false;
+
+    private:
+	std::string name_;
+	int fd_ = -1;
+	std::map<std::string, int> attrs_;
+};
+
+} // namespace
+
+struct simtemp_ctx {
+	int epoll_fd = -1;
+	int wait_for = SIMTEMP_WAIT_DATA;
+	bool waited = false; // ready flags come from simtemp_wait()
+	std::vector<sensor *> sensors;
+	std::vector<struct epoll_event> events;
+
+	~simtemp_ctx()
+	{
+		for (sensor *s : sensors)
+			delete s;
+		if (epoll_fd >= 0)
+			close(epoll_fd);
+	}
+
+	sensor *get(unsigned int id)
+	{
+		return id < sensors.size() ? sensors[id] : nullptr;
+	}
+
+	int set_events(int wait)
+	{
+		struct epoll_event ev = {};
+
+		ev.events = (wait == SIMTEMP_WAIT_ALERT) ? EPOLLPRI :
+							   (EPOLLIN | EPOLLPRI);
+		for (size_t i = 0; i < sensors.size(); i++) {
+			ev.data.u32 = uint32_t(i);
+			if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, sensors[i]->fd(),
+				      &ev) < 0)
+				return -errno;
+		}
+		wait_for = wait;
+		return 0;
+	}
+
+	/* Core decode loop: one read() per sensor per batch of records */
+	template <typename Sink> int drain(size_t max, Sink sink)
+	{
+		simtemp_sample_t buf[read_batch];
+		size_t n = 0;
+
+		for (size_t id = 0; id < sensors.size() && n < max; id++) {
+			sensor *s = sensors[id];
+
+			if (waited && !s->ready)
+				continue;
+
+			while (n < max) {
+				size_t want = std::min(max - n, read_batch);
+				ssize_t len = read(s->fd(), buf,
+						   want * sizeof(buf[0]));
+
+				if (len < 0) {
+					if (errno == EINTR)
+						continue;
+					if (errno != EAGAIN)
+						return n ? int(n) : -errno;
+					s->ready = false;
+					break;
+				}
+
+				size_t got = size_t(len) / sizeof(buf[0]);
+				sink(uint32_t(id), buf, got, n);
+				n += got;
+				if (got < want) {
+					s->ready = false;
+					break;
+				}
+			}
+		}
+
+		return int(n);
+	}
+};
+
+extern "C" {
+
+simtemp_ctx_t *simtemp_open(const char *const *names, unsigned int n_sensors)
+{
+	simtemp_ctx_t *ctx = new (std::nothrow) simtemp_ctx_t;
+	int err;
+
+	if (!ctx) {
+		errno = ENOMEM;
+		return nullptr;
+	}
+
+	ctx->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (ctx->epoll_fd < 0)
+		goto err_errno;
+
+	for (unsigned int i = 0; i < n_sensors; i++) {
+		sensor *s = new (std::nothrow) sensor(names[i]);
+		struct epoll_event ev = {};
+
+		if (!s) {
+			errno = ENOMEM;
+			goto err_errno;
+		}
+		ctx->sensors.push_back(s);
+
+		err = s->open_dev();
+		if (err < 0) {
+			errno = -err;
+			goto err_errno;
+		}
+
+		/* Level triggered: a partially drained sensor stays ready */
+		ev.events = EPOLLIN | EPOLLPRI;
+		ev.data.u32 = i;
+		if (epoll_ctl(ctx->epoll_fd, EPOLL_CTL_ADD, s->fd(), &ev) < 0)
+			goto err_errno;
+	}
+
+	ctx->events.resize(n_sensors ? n_sensors : 1);
+	return ctx;
+
+err_errno:
+	err = errno;
+	delete ctx;
+	errno = err;
+	return nullptr;
+}
+
+void simtemp_close(simtemp_ctx_t *ctx)
+{
+	delete ctx;
+}
+
+int simtemp_epoll_fd(simtemp_ctx_t *ctx)
+{
+	return ctx->epoll_fd;
+}
+
+int simtemp_wait(simtemp_ctx_t *ctx, int timeout_ms, int wait_for)
+{
+	int ret;
+
+	if (wait_for != ctx->wait_for) {
+		ret = ctx->set_events(wait_for);
+		if (ret < 0)
+			return ret;
+	}
+
+	do {
+		ret = epoll_wait(ctx->epoll_fd, ctx->events.data(),
+				 int(ctx->events.size()), timeout_ms);
+	} while (ret < 0 && errno == EINTR);
+	if (ret < 0)
+		return -errno;
+
+	for (sensor *s : ctx->sensors)
+		s->ready = false;
+	for (int i = 0; i < ret; i++)
+		ctx->sensors[ctx->events[i].data.u32]->ready = true;
+	ctx->waited = true;
+
+	return ret;
+}
+
+int simtemp_read_batch(simtemp_ctx_t *ctx, size_t max, uint32_t *sensor,
+		       uint64_t *timestamp_ns, int32_t *temp_mC,
+		       uint32_t *flags, uint32_t *seq, uint32_t *channel)
+{
+	int ret = ctx->drain(max, [&](uint32_t id, const simtemp_sample_t *buf,
+				      size_t got, size_t at) {
+		for (size_t i = 0; i < got; i++) {
+			if (sensor)
+				sensor[at + i] = id;
+			if (timestamp_ns)
+				timestamp_ns[at + i] = buf[i].timestamp_ns;
+			if (temp_mC)
+				temp_mC[at + i] = buf[i].temp_mC;
+			if (flags)
+				flags[at + i] = buf[i].flags;
+			if (seq)
+				seq[at + i] = buf[i].seq;
+			if (channel)
+				channel[at + i] = buf[i].channel;
+		}
+	});
+
+	ctx->waited = false;
+	return ret;
+}
+
+int simtemp_read_raw(simtemp_ctx_t *ctx, size_t max, uint32_t *sensor,
+		     simtemp_sample_t *samples)
+{
+	int ret = ctx->drain(max, [&](uint32_t id, const simtemp_sample_t *buf,
+				      size_t got, size_t at) {
+		memcpy(&samples[at], buf, got * sizeof(buf[0]));
+		if (sensor)
+			for (size_t i = 0; i < got; i++)
+				sensor[at + i] = id;
+	});
+
+	ctx->waited = false;
+	return ret;
+}
+
+int simtemp_set_filter(simtemp_ctx_t *ctx, unsigned int id,
+		       const struct simtemp_filter *filter)
+{
+	sensor *s = ctx->get(id);
+
+	if (!s)
+		return -EINVAL;
+	if (ioctl(s->fd(), SIMTEMP_IOC_SET_FILTER, filter) < 0)
+		return -errno;
+	return 0;
+}
+
+int simtemp_get_stats(simtemp_ctx_t *ctx, unsigned int id,
+		      struct simtemp_stats *stats)
+{
+	sensor *s = ctx->get(id);
+
+	if (!s)
+		return -EINVAL;
+	if (ioctl(s->fd(), SIMTEMP_IOC_GET_STATS, stats) < 0)
+		return -errno;
+	return 0;
+}
+
+int simtemp_get_attr(simtemp_ctx_t *ctx, unsigned int id, const char *attr,
+		     char *buf, size_t len)
+{
+	sensor *s = ctx->get(id);
+	ssize_t n;
+	int fd;
+
+	if (!s || !len)
+		return -EINVAL;
+
+	fd = s->attr_fd(attr);
+	if (fd < 0)
+		return fd;
+
+	/* sysfs regenerates the value on every read at offset 0 */
+	n = pread(fd, buf, len - 1, 0);
+	if (n < 0)
+		return -errno;
+
+	while (n > 0 && (buf[n - 1] == '\n' || buf[n - 1] == ' '))
+		n--;
+	buf[n] = '\0';
+	return int(n);
+}
+
+int simtemp_set_attr(simtemp_ctx_t *ctx, unsigned int id, const char *attr,
+		     const char *value)
+{
+	sensor *s = ctx->get(id);
+	int fd;
+
+	if (!s)
+		return -EINVAL;
+
+	fd = s->attr_fd(attr);
+	if (fd < 0)
+		return fd;
+
+	if (pwrite(fd, value, strlen(value), 0) < 0)
+		return -errno;
+	return 0;
+}
+
+int simtemp_get_attr_long(simtemp_ctx_t *ctx, unsigned int id,
+			  const char *attr, long *value)
+{
+	char buf[32];
+	char *end;
+	int ret;
+
+	ret = simtemp_get_attr(ctx, id, attr, buf, sizeof(buf));
+	if (ret < 0)
+		return ret;
+
+	errno = 0;
+	*value = strtol(buf, &end, 10);
+	if (errno || end == buf)
+		return -EINVAL;
+	return 0;
+}
+
+int simtemp_set_attr_long(simtemp_ctx_t *ctx, unsigned int id,
+			  const char *attr, long value)
+{
+	char buf[32];
+
+	snprintf(buf, sizeof(buf), "%ld", value);
+	return simtemp_set_attr(ctx, id, attr, buf);
+}
+
+} // extern "C"
@@ -0,0 +1,81 @@
+#ifndef LIBSIMTEMP_H
+#define LIBSIMTEMP_H
+
+/*
+** libsimtemp - native consumer library for simtemp sensors (C ABI)
+**
+** Opens many sensor nodes, multiplexes them on one epoll instance, decodes
+** samples in batches into caller-provided arrays and keeps sysfs attributes
+** open between accesses. All functions return >= 0 on success or -errno.
+*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "nxp_simtemp_uapi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SIMTEMP_API __attribute__((visibility("default")))
+
+typedef struct simtemp_ctx simtemp_ctx_t;
+
+/* Wait for any sample, or only for threshold alerts (POLLPRI) */
+#define SIMTEMP_WAIT_DATA 0
+#define SIMTEMP_WAIT_ALERT 1
+
+/*
+ * Open the named sensors ("simtemp", "simtemp-1", ...). The index of a name
+ * in 'names' is its sensor id in every other call. NULL on error (errno set).
+ */
+SIMTEMP_API simtemp_ctx_t *simtemp_open(const char *const *names,
+					unsigned int n_sensors);
+
+SIMTEMP_API void simtemp_close(simtemp_ctx_t *ctx);
+
+/* The epoll fd, to nest the context into another event loop */
+SIMTEMP_API int simtemp_epoll_fd(simtemp_ctx_t *ctx);
+
+/* Wait for ready sensors; returns how many are ready (0 on timeout) */
+SIMTEMP_API int simtemp_wait(simtemp_ctx_t *ctx, int timeout_ms, int wait_for);
+
+/*
+ * Drain ready sensors (all sensors if simtemp_wait() was not called) into up
+ * to 'max' entries of the given arrays; any array may be NULL. Returns the
+ * number of samples decoded, 0 if none is pending.
+ */
+SIMTEMP_API int simtemp_read_batch(simtemp_ctx_t *ctx, size_t max,
+				   uint32_t *sensor, uint64_t *timestamp_ns,
+				   int32_t *temp_mC, uint32_t *flags,
+				   uint32_t *seq, uint32_t *channel);
+
+/* Same as simtemp_read_batch() keeping the raw record layout */
+SIMTEMP_API int simtemp_read_raw(simtemp_ctx_t *ctx, size_t max,
+				 uint32_t *sensor, simtemp_sample_t *samples);
+
+SIMTEMP_API int simtemp_set_filter(simtemp_ctx_t *ctx, unsigned int sensor,
+				   const struct simtemp_filter *filter);
+
+/* Binary statistics snapshot (one ioctl, does not touch the sampler locks) */
+SIMTEMP_API int simtemp_get_stats(simtemp_ctx_t *ctx, unsigned int sensor,
+				  struct simtemp_stats *stats);
+
+/* sysfs attributes (file descriptors are cached per sensor and attribute) */
+SIMTEMP_API int simtemp_get_attr(simtemp_ctx_t *ctx, unsigned int sensor,
+				 const char *attr, char *buf, size_t len);
+
+SIMTEMP_API int simtemp_set_attr(simtemp_ctx_t *ctx, unsigned int sensor,
+				 const char *attr, const char *value);
+
+SIMTEMP_API int simtemp_get_attr_long(simtemp_ctx_t *ctx, unsigned int sensor,
+				      const char *attr, long *value);
+
+SIMTEMP_API int simtemp_set_attr_long(simtemp_ctx_t *ctx, unsigned int sensor,
+				      const char *attr, long value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif